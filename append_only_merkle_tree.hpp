@@ -0,0 +1,150 @@
+#pragma once
+#include <bit>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "merkle_tree.hpp"
+#include "merkle_tree_file.hpp"
+
+
+/**
+ * A Merkle tree that can only be appended to, for log-style workloads. It has the same root hashes and proofs as a
+ * MerkleTree holding the same hashes, but only keeps a small part of the tree in memory.
+ *
+ * The leaves are grouped into chunks of 2^chunkHeight. Only the chunk that is currently being filled (the hot chunk)
+ * is kept in memory; as soon as a chunk is complete, its nodes are written to the cold storage file and dropped from
+ * memory, except for the root of the chunk. The chunk roots are chunked the same way in turn, and so on up the tree:
+ * the levels [t * chunkHeight, (t + 1) * chunkHeight) form tier t, whose leaves are the roots of the chunks of tier
+ * t - 1. Only the hot chunk of each tier is kept in memory, which is less than 2^(chunkHeight + 1) hashes for each of
+ * the ceil(log2(n) / chunkHeight) tiers.
+ *
+ * Every node is hashed exactly once, when its right child is complete, so appending takes an amortized constant
+ * number of hashes (the nodes that are not complete yet, on the right edge of the tree, are only hashed when the root
+ * hash or a proof is requested). Proofs read the sibling hashes inside completed chunks from the cold storage file.
+ *
+ * The const methods only read the cold storage file at given offsets (see ColdStorageFile), so they can be called from
+ * several threads at once, as long as no hash is being added at the same time.
+ */
+template<PersistentMerkleHasher Hasher = StdHasher>
+struct AppendOnlyMerkleTree {
+
+public:
+
+    using hash_t = typename Hasher::digest_type;
+    using proof_t = MerkleProof<hash_t>;
+
+private:
+
+    std::size_t chunkHeight;
+
+    /**
+     * Number of nodes of a chunk written to the cold storage file: all the nodes below the chunk root.
+     */
+    std::size_t chunkNodeCount;
+
+    /**
+     * The file with the nodes of the completed chunks of all tiers, in the order in which they were completed (see
+     * `getChunkPosition`). Each chunk holds the levels of the chunk from the leaves up, each level in order.
+     */
+    ColdStorageFile coldStorage;
+
+    std::size_t currentTreeSize = 0;
+
+    /**
+     * completeNodes[level] holds the hashes of the complete nodes (nodes whose subtrees are all leaves that have been
+     * added) on that level that belong to the hot chunk of their tier. The others are in cold storage.
+     */
+    std::vector<std::vector<hash_t>> completeNodes;
+
+    /**
+     * @return true if the node (level, index) has all of its leaves in the tree.
+     */
+    [[nodiscard]] bool isComplete(const std::size_t level, const std::size_t index) const noexcept {
+        return (index + 1) << level <= currentTreeSize;
+    }
+
+    /**
+     * @return the position (in chunks) in the cold storage file of the given chunk of the given tier. When the tree size
+     * reaches a multiple of 2^(chunkHeight * (t + 1)), a chunk of each tier up to t is completed, and they are written
+     * in the order of their tiers, so this is the number of chunks completed before the end of the given chunk, plus
+     * the number of lower tiers.
+     */
+    [[nodiscard]] std::size_t getChunkPosition(std::size_t tier, std::size_t chunk) const noexcept;
+
+    /**
+     * @return the hash of the complete node (level, index), from memory or from cold storage.
+     * @throws MerkleTreeFileAccessException if the cold storage file cannot be read
+     */
+    [[nodiscard]] hash_t getCompleteNodeHash(std::size_t level, std::size_t index) const;
+
+    /**
+     * @return the hashes of the incomplete nodes on the right edge of the tree (the ancestors of the last leaf that
+     * are not complete), by level, computed from the bottom up. The other entries are value-initialized.
+     */
+    [[nodiscard]] std::vector<hash_t> computeIncompleteNodeHashes() const;
+
+    /**
+     * @return the hash of the node (level, index), which is either complete or incomplete (on the right edge, looked up
+     * in the result of `computeIncompleteNodeHashes`). Nodes without any leaves have no hash.
+     */
+    [[nodiscard]] hash_t getNodeHash(std::size_t level, std::size_t index,
+                                     const std::vector<hash_t> &incompleteNodeHashes) const;
+
+public:
+
+    /**
+     * Create an empty tree whose completed chunks are stored in the file at `coldStoragePath`, which is created if it
+     * does not exist. An existing file has to be empty: it is never truncated.
+     *
+     * With ColdStorageOpenMode::reopen, the tree is instead rebuilt from an existing cold storage file that was written
+     * with the same Hasher and chunkHeight. The file only holds completed chunks, so the tree is restored to the size it
+     * had when the last chunk of leaves was completed; the leaves added after that are lost. Only the chunk roots of the
+     * hot chunks of the upper tiers are read.
+     *
+     * @throws MerkleTreeHeightOutOfRangeException if chunkHeight is 0 or greater than maxTreeHeight
+     * @throws MerkleTreeFileAccessException if the cold storage file cannot be created, is not empty (when creating),
+     * does not exist or cannot be read (when reopening)
+     * @throws MerkleTreeFileFormatException if the length of the reopened file is not a number of chunks that a tree
+     * can have written
+     */
+    explicit AppendOnlyMerkleTree(const std::string &coldStoragePath, std::size_t chunkHeight = 10,
+                                  ColdStorageOpenMode mode = ColdStorageOpenMode::create);
+
+    /**
+     * Append a data hash to the tree, see `MerkleTree::addHashOf`.
+     * @throws MerkleTreeFileAccessException if a completed chunk cannot be written to the cold storage file (neither the
+     * tree nor the file is modified; the same goes for any other exception)
+     */
+    void addHashOf(std::string_view data);
+
+    /**
+     * Get the root hash of the tree, see `MerkleTree::getRootHash`. Takes O(log n) hashes.
+     * @throws MerkleTreeEmptyException if the tree is empty
+     */
+    [[nodiscard]] hash_t getRootHash() const;
+
+    [[nodiscard]] std::size_t getTreeSize() const noexcept {
+        return currentTreeSize;
+    }
+
+    [[nodiscard]] std::size_t getTreeHeight() const noexcept {
+        return currentTreeSize <= 1 ? 0 : static_cast<std::size_t>(std::bit_width(currentTreeSize - 1));
+    }
+
+    /**
+     * @return the number of node hashes held in memory.
+     */
+    [[nodiscard]] std::size_t getResidentHashCount() const noexcept;
+
+    /**
+     * Generate a proof for a given index, see `MerkleTree::generateProof`.
+     *
+     * @throws MerkleNodeIndexOutOfRangeException if the index is out of range (greater than or equal to the tree size)
+     * @throws MerkleTreeEmptyException if the tree is empty
+     * @throws MerkleTreeFileAccessException if the cold storage file cannot be read
+     */
+    [[nodiscard]] proof_t generateProof(std::size_t leafNodeIndex) const;
+};
+
+
+#include "append_only_merkle_tree.tpp"
@@ -0,0 +1,271 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <limits>
+#include "merkle_tree_exceptions.hpp"
+
+
+template<PersistentMerkleHasher Hasher>
+AppendOnlyMerkleTree<Hasher>::AppendOnlyMerkleTree(const std::string &coldStoragePath, const std::size_t chunkHeight,
+                                                   const ColdStorageOpenMode mode)
+    : chunkHeight(chunkHeight == 0 || chunkHeight > maxTreeHeight ? throw MerkleTreeHeightOutOfRangeException()
+                                                                   : chunkHeight),
+      chunkNodeCount((std::size_t{2} << chunkHeight) - 2), coldStorage(coldStoragePath, mode) {
+    completeNodes.resize(chunkHeight + 1);
+
+    const std::uint64_t chunkSize = chunkNodeCount * sizeof(hash_t);
+    if (coldStorage.getSize() % chunkSize != 0) {
+        throw MerkleTreeFileFormatException();
+    }
+
+    /**
+     * After k chunks of leaves, floor(k / 2^(chunkHeight * t)) chunks of tier t have been completed. The file length
+     * determines k, since the total grows with k.
+     */
+    const std::uint64_t chunkCount = coldStorage.getSize() / chunkSize;
+    const auto countChunks = [chunkHeight](const std::uint64_t leafChunkCount) {
+        std::uint64_t count = 0;
+        for (std::size_t shift = 0; shift < std::numeric_limits<std::uint64_t>::digits; shift += chunkHeight) {
+            count += leafChunkCount >> shift;
+        }
+        return count;
+    };
+
+    std::uint64_t first = 0;
+    std::uint64_t last = chunkCount;
+    while (first < last) {
+        const std::uint64_t middle = first + (last - first) / 2;
+        if (countChunks(middle) < chunkCount) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    if (countChunks(first) != chunkCount || first > std::numeric_limits<std::size_t>::max() >> chunkHeight) {
+        throw MerkleTreeFileFormatException();
+    }
+
+    currentTreeSize = static_cast<std::size_t>(first) << chunkHeight;
+
+    /**
+     * The hot chunk of the leaves is empty. The leaves of the hot chunk of each upper tier are the roots of completed
+     * chunks of the tier below, which are hashed from the two nodes on the top level of those chunks.
+     */
+    for (std::size_t tier = 1; chunkHeight * tier < std::numeric_limits<std::size_t>::digits; tier++) {
+        const std::size_t tierLeafCount = currentTreeSize >> (chunkHeight * tier);
+        if (tierLeafCount == 0) {
+            break;
+        }
+
+        const std::size_t tierLevel = chunkHeight * tier;
+        if (completeNodes.size() < tierLevel + chunkHeight) {
+            completeNodes.resize(tierLevel + chunkHeight);
+        }
+
+        const std::size_t hotLeafCount = tierLeafCount % (std::size_t{1} << chunkHeight);
+        for (std::size_t index = tierLeafCount - hotLeafCount; index < tierLeafCount; index++) {
+            std::array<hash_t, 2> topNodes;
+            const std::size_t position = getChunkPosition(tier - 1, index) * chunkNodeCount + chunkNodeCount - 2;
+            coldStorage.read(std::as_writable_bytes(std::span(topNodes)), position * sizeof(hash_t));
+            completeNodes[tierLevel].push_back(Hasher::hashNode(topNodes[0], topNodes[1]));
+
+            for (std::size_t level = tierLevel; (index + 1) % (std::size_t{2} << (level - tierLevel)) == 0; level++) {
+                const std::vector<hash_t> &childNodes = completeNodes[level];
+                completeNodes[level + 1].push_back(
+                        Hasher::hashNode(childNodes[childNodes.size() - 2], childNodes.back()));
+            }
+        }
+    }
+}
+
+template<PersistentMerkleHasher Hasher>
+std::size_t AppendOnlyMerkleTree<Hasher>::getChunkPosition(const std::size_t tier, const std::size_t chunk) const noexcept {
+    const std::size_t chunkEnd = (chunk + 1) << (chunkHeight * (tier + 1));
+
+    std::size_t position = tier;
+    for (std::size_t shift = chunkHeight; shift < std::numeric_limits<std::size_t>::digits; shift += chunkHeight) {
+        position += (chunkEnd - 1) >> shift;
+    }
+
+    return position;
+}
+
+template<PersistentMerkleHasher Hasher>
+typename AppendOnlyMerkleTree<Hasher>::hash_t AppendOnlyMerkleTree<Hasher>::getCompleteNodeHash(
+        const std::size_t level, const std::size_t index) const {
+    const std::size_t tier = level / chunkHeight;
+    const std::size_t levelInChunk = level % chunkHeight;
+    const std::size_t chunkLevelSize = std::size_t{1} << (chunkHeight - levelInChunk);
+    const std::size_t chunk = index / chunkLevelSize;
+    const std::size_t indexInChunk = index % chunkLevelSize;
+
+    const std::size_t tierShift = chunkHeight * (tier + 1);
+    const std::size_t hotChunk = tierShift < std::numeric_limits<std::size_t>::digits ? currentTreeSize >> tierShift : 0;
+
+    if (chunk == hotChunk) {
+        return completeNodes[level][indexInChunk];
+    }
+
+    /**
+     * The levels of a chunk below `levelInChunk` take up 2^chunkHeight + 2^(chunkHeight - 1) + ... +
+     * 2^(chunkHeight - levelInChunk + 1) nodes.
+     */
+    const std::size_t levelOffset =
+            (std::size_t{2} << chunkHeight) - (std::size_t{2} << (chunkHeight - levelInChunk));
+    const std::size_t position = getChunkPosition(tier, chunk) * chunkNodeCount + levelOffset + indexInChunk;
+
+    hash_t nodeHash;
+    coldStorage.read(std::as_writable_bytes(std::span(&nodeHash, 1)), position * sizeof(hash_t));
+    return nodeHash;
+}
+
+template<PersistentMerkleHasher Hasher>
+typename AppendOnlyMerkleTree<Hasher>::hash_t AppendOnlyMerkleTree<Hasher>::getNodeHash(
+        const std::size_t level, const std::size_t index, const std::vector<hash_t> &incompleteNodeHashes) const {
+    if (isComplete(level, index)) {
+        return getCompleteNodeHash(level, index);
+    }
+
+    return incompleteNodeHashes[level];
+}
+
+template<PersistentMerkleHasher Hasher>
+std::vector<typename AppendOnlyMerkleTree<Hasher>::hash_t>
+AppendOnlyMerkleTree<Hasher>::computeIncompleteNodeHashes() const {
+    const std::size_t treeHeight = getTreeHeight();
+    std::vector<hash_t> incompleteNodeHashes(treeHeight + 1);
+
+    /**
+     * An incomplete node whose right child has no leaves is the same as its left child (see `MerkleTree::addHashOf`).
+     */
+    for (std::size_t level = 1; level <= treeHeight; level++) {
+        const std::size_t index = (currentTreeSize - 1) >> level;
+
+        if (isComplete(level, index)) {
+            continue;
+        }
+
+        const hash_t leftChildHash = getNodeHash(level - 1, 2 * index, incompleteNodeHashes);
+
+        if ((2 * index + 1) << (level - 1) >= currentTreeSize) {
+            incompleteNodeHashes[level] = leftChildHash;
+        } else {
+            incompleteNodeHashes[level] =
+                    Hasher::hashNode(leftChildHash, getNodeHash(level - 1, 2 * index + 1, incompleteNodeHashes));
+        }
+    }
+
+    return incompleteNodeHashes;
+}
+
+template<PersistentMerkleHasher Hasher>
+void AppendOnlyMerkleTree<Hasher>::addHashOf(const std::string_view data) {
+    const std::size_t newTreeSize = currentTreeSize + 1;
+
+    /**
+     * The new leaf completes the nodes on levels 1, ..., topNewLevel above it, where 2^topNewLevel is the largest power
+     * of two that divides the new tree size, and with them the hot chunks of the tiers below topNewLevel / chunkHeight.
+     */
+    const auto topNewLevel = static_cast<std::size_t>(std::countr_zero(newTreeSize));
+    const std::size_t completedTierCount = topNewLevel / chunkHeight;
+
+    /**
+     * The completed chunks are written in one go and only dropped from memory once they are in the file. If anything
+     * fails before that, the nodes that have been added are removed again, so that the tree stays as it was.
+     */
+    std::size_t addedLevelCount = 0;
+    try {
+        completeNodes[0].push_back(Hasher::hashLeaf(data));
+        addedLevelCount++;
+
+        /**
+         * The node on level l + 1 above the new leaf has the last two complete nodes on level l as its children.
+         */
+        for (std::size_t level = 0; level < topNewLevel; level++) {
+            if (level + 1 == completeNodes.size()) {
+                completeNodes.emplace_back();
+            }
+
+            const std::vector<hash_t> &childNodes = completeNodes[level];
+            completeNodes[level + 1].push_back(Hasher::hashNode(childNodes[childNodes.size() - 2], childNodes.back()));
+            addedLevelCount++;
+        }
+
+        if (completedTierCount > 0) {
+            std::vector<hash_t> chunkNodes;
+            chunkNodes.reserve(completedTierCount * chunkNodeCount);
+            for (std::size_t level = 0; level < completedTierCount * chunkHeight; level++) {
+                chunkNodes.insert(chunkNodes.end(), completeNodes[level].begin(), completeNodes[level].end());
+            }
+
+            coldStorage.append(std::as_bytes(std::span(chunkNodes)));
+        }
+    } catch (...) {
+        for (std::size_t level = 0; level < addedLevelCount; level++) {
+            completeNodes[level].pop_back();
+        }
+        throw;
+    }
+
+    for (std::size_t level = 0; level < completedTierCount * chunkHeight; level++) {
+        completeNodes[level].clear();
+    }
+
+    currentTreeSize = newTreeSize;
+}
+
+template<PersistentMerkleHasher Hasher>
+typename AppendOnlyMerkleTree<Hasher>::hash_t AppendOnlyMerkleTree<Hasher>::getRootHash() const {
+    if (currentTreeSize == 0) {
+        throw MerkleTreeEmptyException();
+    }
+
+    const std::size_t treeHeight = getTreeHeight();
+    if (isComplete(treeHeight, 0)) {
+        return getCompleteNodeHash(treeHeight, 0);
+    }
+
+    return computeIncompleteNodeHashes()[treeHeight];
+}
+
+template<PersistentMerkleHasher Hasher>
+std::size_t AppendOnlyMerkleTree<Hasher>::getResidentHashCount() const noexcept {
+    std::size_t residentHashCount = 0;
+
+    for (const std::vector<hash_t> &levelNodes : completeNodes) {
+        residentHashCount += levelNodes.size();
+    }
+
+    return residentHashCount;
+}
+
+template<PersistentMerkleHasher Hasher>
+typename AppendOnlyMerkleTree<Hasher>::proof_t
+AppendOnlyMerkleTree<Hasher>::generateProof(const std::size_t leafNodeIndex) const {
+    if (currentTreeSize == 0) {
+        throw MerkleTreeEmptyException();
+    }
+
+    if (leafNodeIndex >= currentTreeSize) {
+        throw MerkleNodeIndexOutOfRangeException();
+    }
+
+    const std::size_t treeHeight = getTreeHeight();
+    const std::vector<hash_t> incompleteNodeHashes = computeIncompleteNodeHashes();
+
+    proof_t proof;
+    proof.leafNodeIndex = leafNodeIndex;
+    proof.treeSize = currentTreeSize;
+    proof.siblingHashes.reserve(treeHeight);
+
+    for (std::size_t level = 0; level < treeHeight; level++) {
+        const std::size_t siblingIndex = (leafNodeIndex >> level) ^ 1;
+
+        if (siblingIndex << level < currentTreeSize) {
+            proof.siblingHashes.push_back(getNodeHash(level, siblingIndex, incompleteNodeHashes));
+        }
+    }
+
+    return proof;
+}
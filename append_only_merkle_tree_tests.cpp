@@ -0,0 +1,190 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "catch2/catch_test_macros.hpp"
+#include "append_only_merkle_tree.hpp"
+
+
+TEST_CASE("AppendOnlyMerkleTree", "[append_only_merkle_tree]") {
+    const std::string coldStoragePath =
+            (std::filesystem::temp_directory_path() / "append_only_merkle_tree_tests.cold").string();
+    std::filesystem::remove(coldStoragePath);
+
+    SECTION("Taking root hash of empty tree throws exception") {
+        const AppendOnlyMerkleTree tree(coldStoragePath);
+        REQUIRE_THROWS_AS(tree.getRootHash(), MerkleTreeEmptyException);
+    }
+
+    SECTION("Chunk height of 0 throws exception") {
+        REQUIRE_THROWS_AS(AppendOnlyMerkleTree(coldStoragePath, 0), MerkleTreeHeightOutOfRangeException);
+    }
+
+    SECTION("Root hashes and proofs match a MerkleTree for {1, 2, ..., 70} leaves") {
+        for (std::size_t chunkHeight = 1; chunkHeight <= 3; chunkHeight++) {
+            std::filesystem::remove(coldStoragePath);
+            AppendOnlyMerkleTree appendOnlyTree(coldStoragePath, chunkHeight);
+            MerkleTree tree;
+
+            for (int i = 0; i < 70; i++) {
+                appendOnlyTree.addHashOf("data " + std::to_string(i));
+                tree.addHashOf("data " + std::to_string(i));
+
+                REQUIRE(appendOnlyTree.getRootHash() == tree.getRootHash());
+                for (std::size_t j = 0; j < tree.getTreeSize(); j++) {
+                    REQUIRE(appendOnlyTree.generateProof(j).siblingHashes == tree.generateProof(j).siblingHashes);
+                }
+            }
+
+            REQUIRE_THROWS_AS(appendOnlyTree.generateProof(70), MerkleNodeIndexOutOfRangeException);
+        }
+    }
+
+    SECTION("Only the hot chunk of each tier stays in memory") {
+        AppendOnlyMerkleTree<Sha256Hasher> appendOnlyTree(coldStoragePath, 6);
+        MerkleTree<Sha256Hasher> tree;
+
+        for (int i = 0; i < 1000; i++) {
+            appendOnlyTree.addHashOf("data " + std::to_string(i));
+            tree.addHashOf("data " + std::to_string(i));
+        }
+
+        REQUIRE(appendOnlyTree.getRootHash() == tree.getRootHash());
+        REQUIRE(appendOnlyTree.generateProof(123).siblingHashes == tree.generateProof(123).siblingHashes);
+
+        /**
+         * 1000 = 15 * 64 + 40: the 40 leaves of the hot chunk and their complete ancestors inside the chunk
+         * (20 + 10 + 5 + 2 + 1), the 15 chunk roots and their complete ancestors (7 + 3 + 1)
+         */
+        REQUIRE(appendOnlyTree.getResidentHashCount() == 40 + 20 + 10 + 5 + 2 + 1 + 15 + 7 + 3 + 1);
+    }
+
+    SECTION("Chunk roots are written to cold storage once a chunk of them is complete") {
+        AppendOnlyMerkleTree<Sha256Hasher> appendOnlyTree(coldStoragePath, 2);
+        MerkleTree<Sha256Hasher> tree;
+
+        for (int i = 0; i < 4096; i++) {
+            appendOnlyTree.addHashOf("data " + std::to_string(i));
+            tree.addHashOf("data " + std::to_string(i));
+        }
+
+        REQUIRE(appendOnlyTree.getRootHash() == tree.getRootHash());
+        REQUIRE(appendOnlyTree.generateProof(2345).siblingHashes == tree.generateProof(2345).siblingHashes);
+
+        /**
+         * 4096 = 4^6: the chunks of all the tiers are complete and on disk, only the root stays in memory.
+         */
+        REQUIRE(appendOnlyTree.getResidentHashCount() == 1);
+
+        appendOnlyTree.addHashOf("data 4096");
+        tree.addHashOf("data 4096");
+        REQUIRE(appendOnlyTree.getRootHash() == tree.getRootHash());
+        REQUIRE(appendOnlyTree.getResidentHashCount() == 2);
+    }
+
+    SECTION("Proofs can be generated from several threads at once") {
+        AppendOnlyMerkleTree<Sha256Hasher> appendOnlyTree(coldStoragePath, 4);
+        MerkleTree<Sha256Hasher> tree;
+
+        for (int i = 0; i < 300; i++) {
+            appendOnlyTree.addHashOf("data " + std::to_string(i));
+            tree.addHashOf("data " + std::to_string(i));
+        }
+
+        std::vector<std::vector<Sha256Digest>> siblingHashes(300);
+        {
+            std::vector<std::jthread> threads;
+            for (std::size_t first = 0; first < 4; first++) {
+                threads.emplace_back([&, first] {
+                    for (std::size_t i = first; i < 300; i += 4) {
+                        siblingHashes[i] = appendOnlyTree.generateProof(i).siblingHashes;
+                    }
+                });
+            }
+        }
+
+        for (std::size_t i = 0; i < 300; i++) {
+            REQUIRE(siblingHashes[i] == tree.generateProof(i).siblingHashes);
+        }
+    }
+
+    SECTION("Cold storage file that is not empty is refused") {
+        std::ofstream(coldStoragePath) << "data";
+        REQUIRE_THROWS_AS(AppendOnlyMerkleTree(coldStoragePath), MerkleTreeFileAccessException);
+        REQUIRE(std::filesystem::file_size(coldStoragePath) == 4);
+    }
+
+    SECTION("Reopened cold storage file restores the tree up to the last completed chunk") {
+        MerkleTree<Sha256Hasher> tree;
+        std::size_t residentHashCount = 0;
+        {
+            AppendOnlyMerkleTree<Sha256Hasher> appendOnlyTree(coldStoragePath, 3);
+            for (int i = 0; i < 1003; i++) {
+                appendOnlyTree.addHashOf("data " + std::to_string(i));
+                if (i < 1000) {
+                    tree.addHashOf("data " + std::to_string(i));
+                }
+                if (i == 999) {
+                    residentHashCount = appendOnlyTree.getResidentHashCount();
+                }
+            }
+        }
+
+        AppendOnlyMerkleTree<Sha256Hasher> appendOnlyTree(coldStoragePath, 3, ColdStorageOpenMode::reopen);
+        REQUIRE(appendOnlyTree.getTreeSize() == 1000);
+        REQUIRE(appendOnlyTree.getResidentHashCount() == residentHashCount);
+        REQUIRE(appendOnlyTree.getRootHash() == tree.getRootHash());
+
+        for (int i = 1000; i < 1100; i++) {
+            appendOnlyTree.addHashOf("data " + std::to_string(i));
+            tree.addHashOf("data " + std::to_string(i));
+        }
+
+        REQUIRE(appendOnlyTree.getRootHash() == tree.getRootHash());
+        for (std::size_t i = 0; i < tree.getTreeSize(); i++) {
+            REQUIRE(appendOnlyTree.generateProof(i).siblingHashes == tree.generateProof(i).siblingHashes);
+        }
+    }
+
+    SECTION("Reopening a cold storage file that is not a whole number of chunks throws exception") {
+        std::ofstream(coldStoragePath) << "data";
+        REQUIRE_THROWS_AS(AppendOnlyMerkleTree(coldStoragePath, 3, ColdStorageOpenMode::reopen),
+                          MerkleTreeFileFormatException);
+    }
+
+    SECTION("Reopening a cold storage file with a number of chunks no tree writes throws exception") {
+        /**
+         * With chunkHeight 1, the second chunk of leaves completes a chunk of tier 1 as well, so there is no tree with
+         * exactly 2 chunks.
+         */
+        std::ofstream(coldStoragePath) << std::string(2 * 2 * sizeof(StdHasher::digest_type), 'x');
+        REQUIRE_THROWS_AS(AppendOnlyMerkleTree(coldStoragePath, 1, ColdStorageOpenMode::reopen),
+                          MerkleTreeFileFormatException);
+    }
+
+    SECTION("Reopening a cold storage file that does not exist throws exception") {
+        REQUIRE_THROWS_AS(AppendOnlyMerkleTree(coldStoragePath, 3, ColdStorageOpenMode::reopen),
+                          MerkleTreeFileAccessException);
+        REQUIRE(!std::filesystem::exists(coldStoragePath));
+    }
+
+    SECTION("Chunk that cannot be written leaves the tree as it was") {
+        if (std::filesystem::exists("/dev/full")) {
+            AppendOnlyMerkleTree appendOnlyTree("/dev/full", 2);
+            MerkleTree tree;
+
+            for (int i = 0; i < 3; i++) {
+                appendOnlyTree.addHashOf("data " + std::to_string(i));
+                tree.addHashOf("data " + std::to_string(i));
+            }
+
+            REQUIRE_THROWS_AS(appendOnlyTree.addHashOf("data 3"), MerkleTreeFileAccessException);
+            REQUIRE(appendOnlyTree.getTreeSize() == 3);
+            REQUIRE(appendOnlyTree.getRootHash() == tree.getRootHash());
+            REQUIRE(appendOnlyTree.getResidentHashCount() == 3 + 1);
+        }
+    }
+
+    std::filesystem::remove(coldStoragePath);
+}
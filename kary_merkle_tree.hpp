@@ -0,0 +1,131 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "merkle_tree_hashers.hpp"
+
+
+/**
+ * A proof that a leaf node of a KaryMerkleTree has a given hash, generated by `KaryMerkleTree::generateProof` and
+ * checked with `verifyKaryProof`.
+ */
+template<typename Digest>
+struct KaryMerkleProof {
+    std::size_t leafNodeIndex = 0;
+
+    /**
+     * Number of hashes in the tree. Together with the index, it tells how many siblings the path node has on each
+     * level (all the nodes of the last group of a level may be missing but the first one).
+     */
+    std::size_t treeSize = 0;
+
+    /**
+     * Hashes of the siblings of the path nodes, level by level from the leaves up and from left to right within a
+     * level, skipping the path node itself. There are at most Arity - 1 of them per level.
+     */
+    std::vector<Digest> siblingHashes;
+};
+
+/**
+ * The arities a KaryMerkleTree supports: 2, 4, 8 and 16. Powers of two keep the index arithmetic to shifts and the
+ * upper bound lets `hashChildren` use a fixed-size buffer (see `maxKaryArity`).
+ */
+template<std::size_t Arity>
+concept KaryArity = std::has_single_bit(Arity) && Arity >= 2 && Arity <= maxKaryArity;
+
+/**
+ * A Merkle tree in which every node has up to `Arity` children instead of two, so that it has ceil(log_Arity(n)) levels
+ * instead of ceil(log2(n)): a proof touches fewer nodes and the children of a node are hashed as a single larger
+ * message (see KaryMerkleHasher), at the cost of Arity - 1 sibling hashes per level instead of one.
+ *
+ * The tree is deliberately kept in memory only and is meant for comparing arities. It cannot be written to a file or
+ * mapped: MappedMerkleTree, AppendOnlyMerkleTree and the tree file format are binary, so the fewer levels do not
+ * translate into fewer disk reads per proof.
+ *
+ * The nodes of a level are stored contiguously, so the children of node i are the nodes Arity * i to
+ * Arity * i + Arity - 1 of the level below, and the shape for sizes that are not a power of Arity follows RFC 6962 as
+ * in MerkleTree: the last node of a level may have fewer children, and a node with a single child simply takes the hash
+ * of that child. With Arity = 2, the root hashes and proofs are the same as those of a MerkleTree.
+ */
+template<std::size_t Arity, KaryMerkleHasher Hasher = StdHasher> requires KaryArity<Arity>
+struct KaryMerkleTree {
+
+public:
+
+    using hash_t = typename Hasher::digest_type;
+    using proof_t = KaryMerkleProof<hash_t>;
+
+    static constexpr std::size_t arity = Arity;
+
+private:
+
+    /**
+     * Hashes of the nodes, level by level from the leaves (level 0) up to the root node (the only node of the top
+     * level).
+     */
+    std::vector<std::vector<hash_t>> levelHashes = {{}};
+
+    /**
+     * @return the hash of the node with the given index on level `level` + 1, computed from its children on `level`.
+     */
+    [[nodiscard]] hash_t hashChildrenOf(std::size_t level, std::size_t parentIndex) const;
+
+    /**
+     * Recompute the ancestors of the leaves from `firstLeafNodeIndex` to the last one, every affected node once.
+     */
+    void updateLevels(std::size_t firstLeafNodeIndex);
+
+public:
+
+    /**
+     * Insert a data hash into the tree, 0-indexed, updating the ancestors of the new leaf (one hash per level).
+     */
+    void addHashOf(std::string_view data);
+
+    /**
+     * Insert the hashes of all the given data into the tree, in order, as if `addHashOf` was called for each of them.
+     * The affected non-leaf nodes are rebuilt level by level, so every node is hashed at most once per call.
+     */
+    void addHashesOf(std::span<const std::string> data);
+
+    /**
+     * Get the root hash of the tree.
+     * @throws MerkleTreeEmptyException if the tree is empty
+     */
+    [[nodiscard]] hash_t getRootHash() const;
+
+    [[nodiscard]] std::size_t getTreeSize() const noexcept {
+        return levelHashes.front().size();
+    }
+
+    /**
+     * @return the number of levels above the leaves.
+     */
+    [[nodiscard]] std::size_t getTreeHeight() const noexcept {
+        return levelHashes.size() - 1;
+    }
+
+    /**
+     * Generate a proof for a given leaf node index, to be used in `verifyKaryProof`.
+     * @throws MerkleNodeIndexOutOfRangeException if the index is out of range (greater than or equal to the tree size)
+     */
+    [[nodiscard]] proof_t generateProof(std::size_t leafNodeIndex) const;
+};
+
+/**
+ * Verify whether the given data was in the tree with the given root hash. `Arity` and `Hasher` have to be the same as
+ * the ones the tree was created with.
+ * @param rootHash the hash of the root node of the tree
+ * @param proof the proof generated by `generateProof`
+ * @param data the data whose presence in the tree is to be verified
+ * @return true if the data was in the tree, false otherwise
+ */
+template<std::size_t Arity, KaryMerkleHasher Hasher = StdHasher> requires KaryArity<Arity>
+[[nodiscard]] bool verifyKaryProof(const typename Hasher::digest_type &rootHash,
+                                   const KaryMerkleProof<typename Hasher::digest_type> &proof, std::string_view data);
+
+
+#include "kary_merkle_tree.tpp"
@@ -0,0 +1,136 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include "merkle_tree_exceptions.hpp"
+
+
+template<std::size_t Arity, KaryMerkleHasher Hasher> requires KaryArity<Arity>
+typename KaryMerkleTree<Arity, Hasher>::hash_t KaryMerkleTree<Arity, Hasher>::hashChildrenOf(
+        const std::size_t level, const std::size_t parentIndex) const {
+    const std::vector<hash_t> &children = levelHashes[level];
+    const std::size_t firstChildIndex = parentIndex * Arity;
+    const std::size_t childCount = std::min(Arity, children.size() - firstChildIndex);
+
+    if (childCount == 1) {
+        return children[firstChildIndex];
+    }
+
+    return Hasher::hashChildren(std::span(children).subspan(firstChildIndex, childCount));
+}
+
+template<std::size_t Arity, KaryMerkleHasher Hasher> requires KaryArity<Arity>
+void KaryMerkleTree<Arity, Hasher>::updateLevels(const std::size_t firstLeafNodeIndex) {
+    std::size_t firstIndex = firstLeafNodeIndex;
+
+    for (std::size_t level = 0; levelHashes[level].size() > 1; level++) {
+        if (level + 1 == levelHashes.size()) {
+            levelHashes.emplace_back();
+        }
+
+        const std::size_t parentCount = (levelHashes[level].size() + Arity - 1) / Arity;
+        const std::size_t firstParentIndex = firstIndex / Arity;
+        levelHashes[level + 1].resize(parentCount);
+
+        for (std::size_t parentIndex = firstParentIndex; parentIndex < parentCount; parentIndex++) {
+            levelHashes[level + 1][parentIndex] = hashChildrenOf(level, parentIndex);
+        }
+
+        firstIndex = firstParentIndex;
+    }
+}
+
+template<std::size_t Arity, KaryMerkleHasher Hasher> requires KaryArity<Arity>
+void KaryMerkleTree<Arity, Hasher>::addHashOf(const std::string_view data) {
+    levelHashes.front().push_back(Hasher::hashLeaf(data));
+    updateLevels(levelHashes.front().size() - 1);
+}
+
+template<std::size_t Arity, KaryMerkleHasher Hasher> requires KaryArity<Arity>
+void KaryMerkleTree<Arity, Hasher>::addHashesOf(const std::span<const std::string> data) {
+    if (data.empty()) {
+        return;
+    }
+
+    const std::size_t firstLeafNodeIndex = getTreeSize();
+    levelHashes.front().reserve(firstLeafNodeIndex + data.size());
+    for (const std::string &value: data) {
+        levelHashes.front().push_back(Hasher::hashLeaf(value));
+    }
+
+    updateLevels(firstLeafNodeIndex);
+}
+
+template<std::size_t Arity, KaryMerkleHasher Hasher> requires KaryArity<Arity>
+typename KaryMerkleTree<Arity, Hasher>::hash_t KaryMerkleTree<Arity, Hasher>::getRootHash() const {
+    if (getTreeSize() == 0) {
+        throw MerkleTreeEmptyException();
+    }
+
+    return levelHashes.back().front();
+}
+
+template<std::size_t Arity, KaryMerkleHasher Hasher> requires KaryArity<Arity>
+typename KaryMerkleTree<Arity, Hasher>::proof_t KaryMerkleTree<Arity, Hasher>::generateProof(
+        const std::size_t leafNodeIndex) const {
+    if (leafNodeIndex >= getTreeSize()) {
+        throw MerkleNodeIndexOutOfRangeException();
+    }
+
+    proof_t proof;
+    proof.leafNodeIndex = leafNodeIndex;
+    proof.treeSize = getTreeSize();
+    proof.siblingHashes.reserve(getTreeHeight() * (Arity - 1));
+
+    std::size_t pathNodeIndex = leafNodeIndex;
+    for (std::size_t level = 0; level < getTreeHeight(); level++, pathNodeIndex /= Arity) {
+        const std::vector<hash_t> &nodes = levelHashes[level];
+        const std::size_t firstIndex = pathNodeIndex / Arity * Arity;
+        const std::size_t endIndex = std::min(firstIndex + Arity, nodes.size());
+
+        for (std::size_t index = firstIndex; index < endIndex; index++) {
+            if (index != pathNodeIndex) {
+                proof.siblingHashes.push_back(nodes[index]);
+            }
+        }
+    }
+
+    return proof;
+}
+
+template<std::size_t Arity, KaryMerkleHasher Hasher> requires KaryArity<Arity>
+bool verifyKaryProof(const typename Hasher::digest_type &rootHash,
+                     const KaryMerkleProof<typename Hasher::digest_type> &proof, const std::string_view data) {
+    /**
+     * Same as `verifyProof`, except that on every level the path node is put among up to Arity - 1 siblings: the
+     * siblings of its group that exist, i.e. that are not after the last node of the level.
+     */
+    if (proof.leafNodeIndex >= proof.treeSize) {
+        return false;
+    }
+
+    typename Hasher::digest_type computedHash = Hasher::hashLeaf(data);
+    std::size_t pathNodeIndex = proof.leafNodeIndex;
+    std::size_t lastNodeIndex = proof.treeSize - 1;
+    std::size_t usedSiblingCount = 0;
+
+    for (; lastNodeIndex > 0; pathNodeIndex /= Arity, lastNodeIndex /= Arity) {
+        const std::size_t firstIndex = pathNodeIndex / Arity * Arity;
+        const std::size_t childCount = std::min(Arity, lastNodeIndex + 1 - firstIndex);
+        if (childCount == 1) {
+            continue;
+        }
+
+        if (proof.siblingHashes.size() - usedSiblingCount < childCount - 1) {
+            return false;
+        }
+
+        std::array<typename Hasher::digest_type, Arity> children;
+        for (std::size_t i = 0; i < childCount; i++) {
+            children[i] = firstIndex + i == pathNodeIndex ? computedHash : proof.siblingHashes[usedSiblingCount++];
+        }
+
+        computedHash = Hasher::hashChildren(std::span(children).first(childCount));
+    }
+
+    return usedSiblingCount == proof.siblingHashes.size() && computedHash == rootHash;
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "catch2/catch_test_macros.hpp"
+#include "kary_merkle_tree.hpp"
+#include "merkle_tree.hpp"
+
+
+/**
+ * Add {1, 2, ..., max(150, Arity^3 + 1)} hashes one at a time and check the height of the tree (the smallest h with Arity^h >=
+ * size). The proofs of all the leaves are checked against the root hash for up to 150 hashes and around every power of
+ * Arity (where the last node of a level goes from full to having a single child).
+ */
+template<std::size_t Arity>
+static void checkProofsOfAllLeaves() {
+    KaryMerkleTree<Arity, Sha256Hasher> tree;
+
+    for (std::size_t treeSize = 1; treeSize <= std::max<std::size_t>(150, Arity * Arity * Arity + 1); treeSize++) {
+        tree.addHashOf("data " + std::to_string(treeSize - 1));
+        const Sha256Digest rootHash = tree.getRootHash();
+
+        std::size_t expectedHeight = 0;
+        std::size_t capacity = 1;
+        for (; capacity < treeSize; capacity *= Arity) {
+            expectedHeight++;
+        }
+        REQUIRE(tree.getTreeHeight() == expectedHeight);
+
+        if (treeSize > 150 && treeSize != capacity && treeSize != capacity / Arity + 1) {
+            continue;
+        }
+
+        for (std::size_t i = 0; i < treeSize; i++) {
+            const auto proof = tree.generateProof(i);
+            REQUIRE(proof.siblingHashes.size() <= expectedHeight * (Arity - 1));
+            REQUIRE(verifyKaryProof<Arity, Sha256Hasher>(rootHash, proof, "data " + std::to_string(i)));
+            REQUIRE_FALSE(verifyKaryProof<Arity, Sha256Hasher>(rootHash, proof, "data " + std::to_string(i + 1)));
+        }
+    }
+}
+
+TEST_CASE("KaryMerkleTree", "[kary_merkle_tree]") {
+    SECTION("Taking root hash of empty tree throws exception") {
+        const KaryMerkleTree<4> tree;
+        REQUIRE_THROWS_AS(tree.getRootHash(), MerkleTreeEmptyException);
+    }
+
+    SECTION("Generating proof for index out of range throws exception") {
+        KaryMerkleTree<4> tree;
+        tree.addHashOf("data");
+        REQUIRE_THROWS_AS(tree.generateProof(1), MerkleNodeIndexOutOfRangeException);
+    }
+
+    SECTION("Arity 2 gives the same root hashes and proofs as MerkleTree") {
+        KaryMerkleTree<2, Sha256Hasher> karyTree;
+        MerkleTree<Sha256Hasher> binaryTree;
+
+        for (int i = 0; i < 70; i++) {
+            karyTree.addHashOf("data " + std::to_string(i));
+            binaryTree.addHashOf("data " + std::to_string(i));
+
+            REQUIRE(karyTree.getRootHash() == binaryTree.getRootHash());
+            REQUIRE(karyTree.generateProof(i / 2).siblingHashes == binaryTree.generateProof(i / 2).siblingHashes);
+        }
+
+        KaryMerkleTree<2> defaultKaryTree;
+        MerkleTree defaultBinaryTree;
+        for (int i = 0; i < 70; i++) {
+            defaultKaryTree.addHashOf("data " + std::to_string(i));
+            defaultBinaryTree.addHashOf("data " + std::to_string(i));
+        }
+        REQUIRE(defaultKaryTree.getRootHash() == defaultBinaryTree.getRootHash());
+    }
+
+    SECTION("Proofs of all leaves are valid for arities 2, 4, 8 and 16") {
+        checkProofsOfAllLeaves<2>();
+        checkProofsOfAllLeaves<4>();
+        checkProofsOfAllLeaves<8>();
+        checkProofsOfAllLeaves<16>();
+    }
+
+    SECTION("Adding hashes in batches gives the same tree as adding them one at a time") {
+        std::vector<std::string> data;
+        for (int i = 0; i < 300; i++) {
+            data.push_back("data " + std::to_string(i));
+        }
+
+        KaryMerkleTree<8> oneByOne, inBatches;
+        for (const std::string &value: data) {
+            oneByOne.addHashOf(value);
+        }
+        inBatches.addHashesOf(std::span(data).first(7));
+        inBatches.addHashesOf(std::span(data).subspan(7, 100));
+        inBatches.addHashesOf(std::span(data).subspan(107));
+
+        REQUIRE(inBatches.getRootHash() == oneByOne.getRootHash());
+        REQUIRE(inBatches.getTreeHeight() == 3);
+    }
+
+    SECTION("Tampered proofs are rejected") {
+        KaryMerkleTree<4, Sha256Hasher> tree;
+        for (int i = 0; i < 50; i++) {
+            tree.addHashOf("data " + std::to_string(i));
+        }
+        const Sha256Digest rootHash = tree.getRootHash();
+
+        auto proof = tree.generateProof(17);
+        proof.siblingHashes[2][0] ^= 1;
+        REQUIRE_FALSE(verifyKaryProof<4, Sha256Hasher>(rootHash, proof, "data 17"));
+
+        proof = tree.generateProof(17);
+        proof.siblingHashes.pop_back();
+        REQUIRE_FALSE(verifyKaryProof<4, Sha256Hasher>(rootHash, proof, "data 17"));
+
+        proof = tree.generateProof(17);
+        proof.leafNodeIndex = 18;
+        REQUIRE_FALSE(verifyKaryProof<4, Sha256Hasher>(rootHash, proof, "data 17"));
+
+        /**
+         * A proof of the 4-ary tree is not valid for a tree of another arity.
+         */
+        proof = tree.generateProof(17);
+        REQUIRE_FALSE(verifyKaryProof<8, Sha256Hasher>(rootHash, proof, "data 17"));
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <bit>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "merkle_tree.hpp"
+#include "merkle_tree_file.hpp"
+
+
+/**
+ * A Merkle tree served directly from a tree file written by `MerkleTree::writeToFile`. Opening the tree maps the file
+ * into memory instead of reading it, so it takes about as long as reading the header no matter how large the tree is,
+ * and proofs are read straight from the page cache. Only the header and the root node are checked when the tree is
+ * opened; `verify` checks all the nodes.
+ *
+ * The mapping is read-only. Hashes added to the tree are appended to the write-ahead region at the end of the file
+ * (so they survive a restart) and the nodes they change are kept in memory, on top of the mapped ones. `checkpoint`
+ * merges them into the node arrays of the file.
+ */
+template<PersistentMerkleHasher Hasher = StdHasher>
+struct MappedMerkleTree {
+
+public:
+
+    using hash_t = typename Hasher::digest_type;
+    using proof_t = MerkleProof<hash_t>;
+
+private:
+
+    std::string path;
+
+    MappedTreeFile file;
+
+    std::size_t storageHeight = 0;
+
+    std::size_t currentTreeSize = 0;
+
+    /**
+     * Hashes of the nodes that changed since the file was written, by their position in the heap order (see
+     * MerkleTreeFileHeader). These take precedence over the mapped hashes.
+     */
+    std::unordered_map<std::size_t, hash_t> changedNodeHashes;
+
+    /**
+     * @return the position of the node (level, index) in the heap order, with levels counted from the bottom.
+     */
+    [[nodiscard]] std::size_t getNodePosition(const std::size_t level, const std::size_t index) const noexcept {
+        return (std::size_t{1} << (storageHeight - level)) + index;
+    }
+
+    /**
+     * @return the hash of the node (level, index), from `changedNodeHashes` if it has changed and from the mapped
+     * file otherwise.
+     */
+    [[nodiscard]] hash_t getNodeHash(std::size_t level, std::size_t index) const noexcept;
+
+    /**
+     * Store the given leaf hash as the next leaf and rehash its ancestors into `changedNodeHashes`.
+     */
+    void appendLeafHash(const hash_t &leafHash);
+
+public:
+
+    /**
+     * Open the tree file at `path` and replay its write-ahead region. The file is opened read-only until the first
+     * hash is added.
+     *
+     * @throws MerkleTreeFileAccessException if the file cannot be opened or mapped
+     * @throws MerkleTreeFileFormatException if the file is not a valid tree file or was written with a different hash
+     * function policy
+     */
+    explicit MappedMerkleTree(std::string path);
+
+    /**
+     * Insert a data hash into the tree, like `MerkleTree::addHashOf`. The hash is written to the file before the tree
+     * is changed. The tree cannot grow past the height it was written with.
+     *
+     * @throws MerkleTreeFullException if the stored tree is full
+     * @throws MerkleTreeFileAccessException if the hash cannot be written to the file (the tree is not modified)
+     */
+    void addHashOf(std::string_view data);
+
+    /**
+     * Get the root hash of the tree, see `MerkleTree::getRootHash`.
+     * @throws MerkleTreeEmptyException if the tree is empty
+     */
+    [[nodiscard]] hash_t getRootHash() const;
+
+    [[nodiscard]] std::size_t getTreeSize() const noexcept {
+        return currentTreeSize;
+    }
+
+    [[nodiscard]] std::size_t getTreeHeight() const noexcept {
+        return currentTreeSize <= 1 ? 0 : static_cast<std::size_t>(std::bit_width(currentTreeSize - 1));
+    }
+
+    /**
+     * Generate a proof for a given index, see `MerkleTree::generateProof`. The proofs are the same as the ones of a
+     * MerkleTree holding the same hashes.
+     *
+     * @throws MerkleNodeIndexOutOfRangeException if the index is out of range (greater than or equal to the tree size)
+     * @throws MerkleTreeEmptyException if the tree is empty
+     */
+    [[nodiscard]] proof_t generateProof(std::size_t leafNodeIndex) const;
+
+    /**
+     * Check all the node hashes of the file against its node checksum, which reads the whole file.
+     * @throws MerkleTreeFileFormatException if the file has been corrupted
+     */
+    void verify() const {
+        file.verifyNodeHashes();
+    }
+
+    /**
+     * Rewrite the file with the changed nodes merged into its node arrays and an empty write-ahead region, and map the
+     * new file. This reads and writes the whole tree, so it is meant to be done every now and then, e.g. when the
+     * write-ahead region has grown large. The new file is written and mapped under a temporary name before it replaces
+     * the old one, so the tree never keeps appending to a file that is no longer at `path`.
+     *
+     * @throws MerkleTreeFileAccessException if the file cannot be written or mapped (the old file is left in place and
+     * the tree keeps using it), or if the rename cannot be flushed to disk (the tree already uses the new file)
+     */
+    void checkpoint();
+};
+
+
+#include "mapped_merkle_tree.tpp"
@@ -0,0 +1,136 @@
+#pragma once
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "merkle_tree_exceptions.hpp"
+
+
+template<PersistentMerkleHasher Hasher>
+MappedMerkleTree<Hasher>::MappedMerkleTree(std::string path) : path(std::move(path)), file(this->path) {
+    const MerkleTreeFileHeader &header = file.getHeader();
+
+    if (header.hasherId != Hasher::hasherId || header.digestSize != sizeof(hash_t)) {
+        throw MerkleTreeFileFormatException();
+    }
+
+    storageHeight = header.storageHeight;
+    currentTreeSize = header.treeSize;
+
+    /**
+     * Every record in the write-ahead region is a leaf hash that was added after the file was written, so replaying
+     * them in order brings the tree back to the state it was in when it was last changed.
+     */
+    const std::span<const std::byte> writeAheadRecords = file.getWriteAheadRecords();
+
+    for (std::size_t offset = 0; offset < writeAheadRecords.size(); offset += sizeof(hash_t)) {
+        if (currentTreeSize == std::size_t{1} << storageHeight) {
+            throw MerkleTreeFileFormatException();
+        }
+
+        hash_t leafHash;
+        std::memcpy(&leafHash, writeAheadRecords.data() + offset, sizeof(hash_t));
+        appendLeafHash(leafHash);
+    }
+}
+
+template<PersistentMerkleHasher Hasher>
+typename MappedMerkleTree<Hasher>::hash_t MappedMerkleTree<Hasher>::getNodeHash(const std::size_t level,
+                                                                              const std::size_t index) const noexcept {
+    const std::size_t position = getNodePosition(level, index);
+
+    if (const auto changedNode = changedNodeHashes.find(position); changedNode != changedNodeHashes.end()) {
+        return changedNode->second;
+    }
+
+    /**
+     * The mapped bytes are copied out rather than accessed in place, since the file does not guarantee any alignment
+     * beyond that of the header.
+     */
+    hash_t nodeHash;
+    std::memcpy(&nodeHash, file.getNodeHashes().data() + position * sizeof(hash_t), sizeof(hash_t));
+    return nodeHash;
+}
+
+template<PersistentMerkleHasher Hasher>
+void MappedMerkleTree<Hasher>::appendLeafHash(const hash_t &leafHash) {
+    std::size_t index = currentTreeSize;
+    changedNodeHashes[getNodePosition(0, index)] = leafHash;
+    currentTreeSize++;
+
+    for (std::size_t level = 1; level <= storageHeight; level++) {
+        index /= 2;
+        const hash_t leftChildHash = getNodeHash(level - 1, 2 * index);
+
+        if ((2 * index + 1) << (level - 1) >= currentTreeSize) {
+            changedNodeHashes[getNodePosition(level, index)] = leftChildHash;
+        } else {
+            changedNodeHashes[getNodePosition(level, index)] =
+                    Hasher::hashNode(leftChildHash, getNodeHash(level - 1, 2 * index + 1));
+        }
+    }
+}
+
+template<PersistentMerkleHasher Hasher>
+void MappedMerkleTree<Hasher>::addHashOf(const std::string_view data) {
+    if (currentTreeSize == std::size_t{1} << storageHeight) {
+        throw MerkleTreeFullException();
+    }
+
+    const hash_t leafHash = Hasher::hashLeaf(data);
+    file.appendWriteAheadRecord(std::as_bytes(std::span(&leafHash, 1)));
+    appendLeafHash(leafHash);
+}
+
+template<PersistentMerkleHasher Hasher>
+typename MappedMerkleTree<Hasher>::hash_t MappedMerkleTree<Hasher>::getRootHash() const {
+    if (currentTreeSize == 0) {
+        throw MerkleTreeEmptyException();
+    }
+
+    return getNodeHash(getTreeHeight(), 0);
+}
+
+template<PersistentMerkleHasher Hasher>
+typename MappedMerkleTree<Hasher>::proof_t MappedMerkleTree<Hasher>::generateProof(const std::size_t leafNodeIndex) const {
+    if (currentTreeSize == 0) {
+        throw MerkleTreeEmptyException();
+    }
+
+    if (leafNodeIndex >= currentTreeSize) {
+        throw MerkleNodeIndexOutOfRangeException();
+    }
+
+    const std::size_t treeHeight = getTreeHeight();
+
+    proof_t proof;
+    proof.leafNodeIndex = leafNodeIndex;
+    proof.treeSize = currentTreeSize;
+    proof.siblingHashes.reserve(treeHeight);
+
+    for (std::size_t level = 0; level < treeHeight; level++) {
+        const std::size_t siblingIndex = (leafNodeIndex >> level) ^ 1;
+
+        if (siblingIndex << level < currentTreeSize) {
+            proof.siblingHashes.push_back(getNodeHash(level, siblingIndex));
+        }
+    }
+
+    return proof;
+}
+
+template<PersistentMerkleHasher Hasher>
+void MappedMerkleTree<Hasher>::checkpoint() {
+    const std::span<const std::byte> mappedNodeHashes = file.getNodeHashes();
+    std::vector<std::byte> nodeHashes(mappedNodeHashes.begin(), mappedNodeHashes.end());
+
+    for (const auto &[position, nodeHash] : changedNodeHashes) {
+        std::memcpy(nodeHashes.data() + position * sizeof(hash_t), &nodeHash, sizeof(hash_t));
+    }
+
+    MerkleTreeFileHeader header = file.getHeader();
+    header.treeSize = currentTreeSize;
+
+    file = replaceTreeFile(path, header, nodeHashes);
+    changedNodeHashes.clear();
+    syncTreeFileDirectory(path);
+}
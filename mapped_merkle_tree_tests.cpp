@@ -0,0 +1,159 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "catch2/catch_test_macros.hpp"
+#include "mapped_merkle_tree.hpp"
+
+
+/**
+ * Path of a tree file in the temporary directory, removed (along with any leftover temporary file) when it goes out
+ * of scope.
+ */
+struct TemporaryTreeFile {
+    std::string path = (std::filesystem::temp_directory_path() / "mapped_merkle_tree_tests.tree").string();
+
+    ~TemporaryTreeFile() {
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + ".tmp");
+    }
+};
+
+template<PersistentMerkleHasher Hasher>
+static void requireSameTree(const MerkleTree<Hasher> &tree, const MappedMerkleTree<Hasher> &mappedTree) {
+    REQUIRE(mappedTree.getTreeSize() == tree.getTreeSize());
+    REQUIRE(mappedTree.getRootHash() == tree.getRootHash());
+
+    for (std::size_t i = 0; i < tree.getTreeSize(); i++) {
+        REQUIRE(mappedTree.generateProof(i).siblingHashes == tree.generateProof(i).siblingHashes);
+    }
+}
+
+TEST_CASE("MappedMerkleTree", "[mapped_merkle_tree]") {
+    TemporaryTreeFile treeFile;
+    MerkleTreeOptions options;
+    options.initialHeight = 7;
+    MerkleTree tree(options);
+
+    for (int i = 0; i < 50; i++) {
+        tree.addHashOf("data " + std::to_string(i));
+    }
+    tree.writeToFile(treeFile.path);
+
+    SECTION("Opened tree has the same root hash and proofs as the tree that was written") {
+        const MappedMerkleTree mappedTree(treeFile.path);
+        requireSameTree(tree, mappedTree);
+    }
+
+    SECTION("Hashes added to the opened tree are kept after reopening it and after a checkpoint") {
+        {
+            MappedMerkleTree mappedTree(treeFile.path);
+            for (int i = 50; i < 100; i++) {
+                tree.addHashOf("data " + std::to_string(i));
+                mappedTree.addHashOf("data " + std::to_string(i));
+            }
+            requireSameTree(tree, mappedTree);
+        }
+
+        MappedMerkleTree reopenedTree(treeFile.path);
+        requireSameTree(tree, reopenedTree);
+
+        reopenedTree.checkpoint();
+        tree.addHashOf("data 100");
+        reopenedTree.addHashOf("data 100");
+        requireSameTree(tree, reopenedTree);
+
+        const MappedMerkleTree checkpointedTree(treeFile.path);
+        requireSameTree(tree, checkpointedTree);
+        REQUIRE(std::filesystem::file_size(treeFile.path) ==
+                sizeof(MerkleTreeFileHeader) + (std::size_t{2} << 7) * sizeof(hash_t) + sizeof(hash_t));
+    }
+
+    SECTION("Failed checkpoint leaves the old file in place and in use") {
+        MappedMerkleTree mappedTree(treeFile.path);
+        std::filesystem::create_directory(treeFile.path + ".tmp");
+
+        REQUIRE_THROWS_AS(mappedTree.checkpoint(), MerkleTreeFileAccessException);
+        tree.addHashOf("data 50");
+        mappedTree.addHashOf("data 50");
+        requireSameTree(tree, mappedTree);
+        requireSameTree(tree, MappedMerkleTree(treeFile.path));
+    }
+
+    SECTION("Incomplete record at the end of the write-ahead region is ignored") {
+        {
+            MappedMerkleTree mappedTree(treeFile.path);
+            mappedTree.addHashOf("data 50");
+        }
+
+        std::ofstream(treeFile.path, std::ios::binary | std::ios::app) << "abc";
+        const std::size_t nodeArraysEnd = sizeof(MerkleTreeFileHeader) + (std::size_t{2} << 7) * sizeof(hash_t);
+
+        /**
+         * Opening the tree only skips the incomplete record, the file is not changed until the next hash is added.
+         */
+        MappedMerkleTree mappedTree(treeFile.path);
+        tree.addHashOf("data 50");
+        requireSameTree(tree, mappedTree);
+        REQUIRE(std::filesystem::file_size(treeFile.path) == nodeArraysEnd + sizeof(hash_t) + 3);
+
+        mappedTree.addHashOf("data 51");
+        tree.addHashOf("data 51");
+        requireSameTree(tree, MappedMerkleTree(treeFile.path));
+        REQUIRE(std::filesystem::file_size(treeFile.path) == nodeArraysEnd + 2 * sizeof(hash_t));
+    }
+
+    SECTION("Adding a hash to a full tree throws exception") {
+        MappedMerkleTree mappedTree(treeFile.path);
+        for (int i = 50; i < 128; i++) {
+            mappedTree.addHashOf("data");
+        }
+
+        REQUIRE_THROWS_AS(mappedTree.addHashOf("129th data node"), MerkleTreeFullException);
+    }
+
+    SECTION("Opening a file with a different hash function policy throws exception") {
+        REQUIRE_THROWS_AS(MappedMerkleTree<Sha256Hasher>(treeFile.path), MerkleTreeFileFormatException);
+    }
+
+    SECTION("Opening a file with a corrupted header throws exception") {
+        std::fstream(treeFile.path, std::ios::binary | std::ios::in | std::ios::out).seekp(24).put('\x01');
+
+        REQUIRE_THROWS_AS(MappedMerkleTree(treeFile.path), MerkleTreeFileFormatException);
+    }
+
+    SECTION("Verifying a file with a corrupted leaf hash throws exception") {
+        MappedMerkleTree(treeFile.path).verify();
+
+        const auto leafOffset = static_cast<std::streamoff>(sizeof(MerkleTreeFileHeader) + (128 + 3) * sizeof(hash_t));
+        std::fstream(treeFile.path, std::ios::binary | std::ios::in | std::ios::out).seekp(leafOffset).put('\x01');
+
+        const MappedMerkleTree mappedTree(treeFile.path);
+        REQUIRE_THROWS_AS(mappedTree.verify(), MerkleTreeFileFormatException);
+    }
+
+    SECTION("Opening a file with a corrupted root hash throws exception") {
+        const auto rootOffset = static_cast<std::streamoff>(sizeof(MerkleTreeFileHeader) + 2 * sizeof(hash_t));
+        std::fstream(treeFile.path, std::ios::binary | std::ios::in | std::ios::out).seekp(rootOffset).put('\x01');
+
+        REQUIRE_THROWS_AS(MappedMerkleTree(treeFile.path), MerkleTreeFileFormatException);
+    }
+
+    SECTION("Opening a file that does not exist throws exception") {
+        REQUIRE_THROWS_AS(MappedMerkleTree(treeFile.path + ".missing"), MerkleTreeFileAccessException);
+    }
+}
+
+TEST_CASE("MappedMerkleTree with SHA-256", "[mapped_merkle_tree]") {
+    TemporaryTreeFile treeFile;
+    MerkleTree<Sha256Hasher> tree;
+
+    for (int i = 0; i < 20; i++) {
+        tree.addHashOf("data " + std::to_string(i));
+    }
+    tree.writeToFile(treeFile.path);
+
+    const MappedMerkleTree<Sha256Hasher> mappedTree(treeFile.path);
+    requireSameTree(tree, mappedTree);
+}
@@ -0,0 +1,232 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "merkle_tree_hashers.hpp"
+
+
+/**
+ * A node on the path of a key through a MerklePatriciaTrie, with everything needed to recompute its hash except for
+ * the hash of the next node on the path.
+ */
+template<typename Digest>
+struct MerklePatriciaProofNode {
+    /**
+     * The compressed part of the path that leads through the node, one nibble (0 to 15) per character.
+     */
+    std::string pathNibbles;
+
+    std::optional<Digest> valueHash;
+
+    /**
+     * Hashes of the children of the node, sorted by nibble, except for the child on the path of the key (which only the
+     * last node of the proof does not have).
+     */
+    std::vector<std::pair<std::uint8_t, Digest>> childHashes;
+};
+
+/**
+ * A proof that a key is or is not in a MerklePatriciaTrie, generated by `MerklePatriciaTrie::generateProof` and checked
+ * with `verifyTrieInclusion` or `verifyTrieAbsence`: the nodes on the path of the key from the root node down to the
+ * node where the key either ends or leaves the trie. There is at most one node per nibble of the key (and the root
+ * node), so the size of a proof depends on the length of the key, not on the number of keys.
+ */
+template<typename Digest>
+struct MerklePatriciaProof {
+    std::vector<MerklePatriciaProofNode<Digest>> nodes;
+};
+
+/**
+ * The bytes that the messages of value hashes and of trie node hashes start with. Both are hashed with
+ * `Hasher::hashLeaf` (the only way a MerkleHasher hashes arbitrary messages), so without them the hash of a node could
+ * equal the hash of a value and a proof could pass off one as the other.
+ */
+constexpr std::uint8_t trieValueHashPrefix = 0x00;
+constexpr std::uint8_t trieNodeHashPrefix = 0x01;
+
+/**
+ * A key-value commitment for keys of any length: a radix trie of the keys' nibbles (each byte is two nibbles, the high
+ * one first) with 16 children per node, in which every node also commits to the hashes of its children, as in
+ * Ethereum's Merkle Patricia trie.
+ *
+ * Paths are compressed: a chain of nodes without values that have a single child each is merged into its lowest node,
+ * which keeps the skipped nibbles in `pathNibbles`. Every node except the root node therefore has a value or at least
+ * two children, the shape of the trie only depends on the keys it contains (not on the order in which they were put
+ * or removed), and a path has at most one node per nibble of its key.
+ *
+ * Node hashes are cached: changes only mark the nodes on the changed paths dirty, and the dirty nodes are rehashed
+ * (children first) once the root hash or a proof is requested, similarly to `MerkleTreeOptions::lazyRootUpdates`. A
+ * batch of changes (`update`) therefore rehashes every node shared by several of the changed paths only once. Note that
+ * `getRootHash` and `generateProof` then modify the trie, so concurrent reads need to be synchronized as well, unless
+ * no node has changed since the root hash was last requested.
+ */
+template<MerkleHasher Hasher = StdHasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+struct MerklePatriciaTrie {
+
+public:
+
+    using hash_t = typename Hasher::digest_type;
+    using proof_t = MerklePatriciaProof<hash_t>;
+
+    static constexpr std::size_t childCount = 16;
+
+private:
+
+    struct TrieNode {
+        std::string pathNibbles;
+
+        std::optional<hash_t> valueHash;
+
+        std::array<std::unique_ptr<TrieNode>, childCount> children;
+
+        mutable hash_t hash{};
+
+        mutable bool isDirty = true;
+
+        [[nodiscard]] bool isEmpty() const noexcept;
+    };
+
+    TrieNode root;
+
+    std::size_t keyCount = 0;
+
+    /**
+     * The buffer that the messages of value hashes and node hashes are built in, kept so that its memory is reused.
+     */
+    mutable std::string hashMessage;
+
+    /**
+     * @return the nibbles of the key from nibble `position` on, one per character.
+     */
+    [[nodiscard]] static std::string getPathNibbles(std::string_view key, std::size_t position);
+
+    /**
+     * Put the value hash into the subtree of the node, the path of which starts at nibble `position` of the key.
+     * @return true if the key was not in the subtree yet
+     */
+    static bool putIntoNode(TrieNode &node, std::string_view key, std::size_t position, const hash_t &valueHash);
+
+    /**
+     * Remove the key from the subtree of the node, the path of which starts at nibble `position` of the key.
+     * @return true if the key was in the subtree
+     */
+    static bool removeFromNode(TrieNode &node, std::string_view key, std::size_t position);
+
+    /**
+     * Merge the node with its only child if the node has no value (see path compression above).
+     */
+    static void compressNode(TrieNode &node);
+
+    /**
+     * Recompute the hashes of the dirty nodes in the subtree of the node, building the messages in `message`.
+     */
+    static void rehashDirtyNodes(const TrieNode &node, std::string &message);
+
+public:
+
+    /**
+     * @return nibble `position` of the key, the high half of byte position / 2 for even positions and the low half for
+     * odd ones.
+     */
+    [[nodiscard]] static std::uint8_t getNibble(const std::string_view key, const std::size_t position) noexcept {
+        const auto byte = static_cast<std::uint8_t>(key[position / 2]);
+        return position % 2 == 0 ? byte >> 4 : byte & 0x0f;
+    }
+
+    /**
+     * @return the number of path nibbles that match the nibbles of the key from nibble `position` on.
+     */
+    [[nodiscard]] static std::size_t getCommonPrefixLength(std::string_view pathNibbles, std::string_view key,
+                                                           std::size_t position) noexcept;
+
+    /**
+     * @return the hash of a value: the leaf hash of `trieValueHashPrefix` followed by the value. The message is built in
+     * `message`, which only serves as a buffer that can be reused between calls.
+     */
+    [[nodiscard]] static hash_t hashValue(std::string_view value, std::string &message);
+
+    /**
+     * @return the hash of a node with the given path nibbles, value hash and child hashes (sorted by nibble): the leaf
+     * hash of `trieNodeHashPrefix` followed by the length of the path, the path, the value hash (if any), a bitmask of
+     * the children and their hashes. The message is built in `message`, as in `hashValue`.
+     */
+    [[nodiscard]] static hash_t hashTrieNode(std::string_view pathNibbles, const std::optional<hash_t> &valueHash,
+                                             std::span<const std::pair<std::uint8_t, hash_t>> childHashes,
+                                             std::string &message);
+
+    /**
+     * Follow the path of the key through the nodes of the proof and compute the root hash from them.
+     *
+     * @param terminalPosition set to the nibble of the key at which the path of the last node of the proof starts
+     * @return the root hash, or std::nullopt if the nodes do not lie on the path of the key or the child hashes are not
+     * sorted
+     */
+    [[nodiscard]] static std::optional<hash_t> computeRootHash(std::string_view key, const proof_t &proof,
+                                                               std::size_t &terminalPosition);
+
+    /**
+     * Set the value of a key, adding the key if it is not in the trie yet. Only the hash of the value is stored.
+     */
+    void put(std::string_view key, std::string_view value);
+
+    /**
+     * Remove a key from the trie.
+     * @return true if the key was in the trie, false otherwise
+     */
+    bool remove(std::string_view key);
+
+    /**
+     * Apply many changes at once, as if `put` (or `remove`, for std::nullopt values) was called for each of them in
+     * order. The node hashes are only recomputed the next time they are needed, so the nodes shared by the paths of
+     * the changed keys are hashed once for the whole batch.
+     */
+    void update(std::span<const std::pair<std::string, std::optional<std::string>>> changes);
+
+    /**
+     * @return the hash of the value of the key (see `hashValue`), or std::nullopt if the key is not in the trie.
+     */
+    [[nodiscard]] std::optional<hash_t> get(std::string_view key) const;
+
+    /**
+     * Get the root hash of the trie, rehashing the nodes changed since the last call. An empty trie has the hash of a
+     * root node without a path, a value or children.
+     */
+    [[nodiscard]] hash_t getRootHash() const;
+
+    [[nodiscard]] std::size_t getKeyCount() const noexcept {
+        return keyCount;
+    }
+
+    /**
+     * Generate a proof for a given key, to be used in `verifyTrieInclusion` if the key is in the trie and in
+     * `verifyTrieAbsence` if it is not.
+     */
+    [[nodiscard]] proof_t generateProof(std::string_view key) const;
+};
+
+/**
+ * Verify whether the key had the given value in the trie with the given root hash.
+ * `Hasher` has to be the same hash function policy that the trie was created with.
+ */
+template<MerkleHasher Hasher = StdHasher>
+[[nodiscard]] bool verifyTrieInclusion(const typename Hasher::digest_type &rootHash, std::string_view key,
+                                       std::string_view value,
+                                       const MerklePatriciaProof<typename Hasher::digest_type> &proof);
+
+/**
+ * Verify whether the key was absent from the trie with the given root hash, i.e. whether its path leaves the trie (in
+ * the middle of a compressed path or at a missing child) or ends at a node without a value.
+ * `Hasher` has to be the same hash function policy that the trie was created with.
+ */
+template<MerkleHasher Hasher = StdHasher>
+[[nodiscard]] bool verifyTrieAbsence(const typename Hasher::digest_type &rootHash, std::string_view key,
+                                     const MerklePatriciaProof<typename Hasher::digest_type> &proof);
+
+
+#include "merkle_patricia_trie.tpp"
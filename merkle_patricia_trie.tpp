@@ -0,0 +1,390 @@
+#pragma once
+#include <algorithm>
+
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+bool MerklePatriciaTrie<Hasher>::TrieNode::isEmpty() const noexcept {
+    return !valueHash && std::none_of(children.begin(), children.end(), [](const auto &child) { return child != nullptr; });
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+std::string MerklePatriciaTrie<Hasher>::getPathNibbles(const std::string_view key, const std::size_t position) {
+    std::string pathNibbles(key.size() * 2 - position, '\0');
+    for (std::size_t i = 0; i < pathNibbles.size(); i++) {
+        pathNibbles[i] = static_cast<char>(getNibble(key, position + i));
+    }
+    return pathNibbles;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+std::size_t MerklePatriciaTrie<Hasher>::getCommonPrefixLength(const std::string_view pathNibbles,
+                                                              const std::string_view key,
+                                                              const std::size_t position) noexcept {
+    const std::size_t maxLength = std::min(pathNibbles.size(), key.size() * 2 - position);
+
+    std::size_t length = 0;
+    while (length < maxLength && static_cast<std::uint8_t>(pathNibbles[length]) == getNibble(key, position + length)) {
+        length++;
+    }
+    return length;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+typename MerklePatriciaTrie<Hasher>::hash_t MerklePatriciaTrie<Hasher>::hashValue(const std::string_view value,
+                                                                                std::string &message) {
+    message.assign(1, static_cast<char>(trieValueHashPrefix));
+    message.append(value);
+    return Hasher::hashLeaf(message);
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+typename MerklePatriciaTrie<Hasher>::hash_t MerklePatriciaTrie<Hasher>::hashTrieNode(
+        const std::string_view pathNibbles, const std::optional<hash_t> &valueHash,
+        const std::span<const std::pair<std::uint8_t, hash_t>> childHashes, std::string &message) {
+    const std::uint64_t pathLength = pathNibbles.size();
+    std::uint16_t childMask = 0;
+    for (const auto &[nibble, childHash]: childHashes) {
+        childMask |= static_cast<std::uint16_t>(1u << nibble);
+    }
+
+    message.assign(1, static_cast<char>(trieNodeHashPrefix));
+    message.append(reinterpret_cast<const char *>(&pathLength), sizeof(pathLength));
+    message.append(pathNibbles);
+    message.push_back(valueHash ? 1 : 0);
+    if (valueHash) {
+        message.append(reinterpret_cast<const char *>(&*valueHash), sizeof(hash_t));
+    }
+    message.append(reinterpret_cast<const char *>(&childMask), sizeof(childMask));
+    for (const auto &[nibble, childHash]: childHashes) {
+        message.append(reinterpret_cast<const char *>(&childHash), sizeof(hash_t));
+    }
+
+    return Hasher::hashLeaf(message);
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+std::optional<typename MerklePatriciaTrie<Hasher>::hash_t> MerklePatriciaTrie<Hasher>::computeRootHash(
+        const std::string_view key, const proof_t &proof, std::size_t &terminalPosition) {
+    if (proof.nodes.empty()) {
+        return std::nullopt;
+    }
+
+    /**
+     * Every node but the last one has to be followed by the next nibble of the key, which leads to the next node.
+     */
+    const std::size_t keyNibbleCount = key.size() * 2;
+    std::size_t position = 0;
+    for (std::size_t i = 0; i + 1 < proof.nodes.size(); i++) {
+        const std::string &pathNibbles = proof.nodes[i].pathNibbles;
+        if (keyNibbleCount - position <= pathNibbles.size()
+            || getCommonPrefixLength(pathNibbles, key, position) != pathNibbles.size()) {
+            return std::nullopt;
+        }
+        position += pathNibbles.size() + 1;
+    }
+    terminalPosition = position;
+
+    /**
+     * The nodes are then hashed from the bottom up, each with the hash of the node below it as the child on the path.
+     */
+    hash_t hash{};
+    std::string message;
+    for (std::size_t i = proof.nodes.size(); i-- > 0;) {
+        const MerklePatriciaProofNode<hash_t> &node = proof.nodes[i];
+        const bool hasPathChild = i + 1 < proof.nodes.size();
+        const std::uint8_t pathNibble = hasPathChild ? getNibble(key, position - 1) : 0;
+
+        std::array<std::pair<std::uint8_t, hash_t>, childCount> childHashes;
+        std::size_t childHashCount = 0;
+        bool isPathChildAdded = !hasPathChild;
+        int previousNibble = -1;
+
+        for (const auto &[nibble, childHash]: node.childHashes) {
+            if (nibble <= previousNibble || nibble >= childCount || (hasPathChild && nibble == pathNibble)) {
+                return std::nullopt;
+            }
+            if (!isPathChildAdded && pathNibble < nibble) {
+                childHashes[childHashCount++] = {pathNibble, hash};
+                isPathChildAdded = true;
+            }
+            childHashes[childHashCount++] = {nibble, childHash};
+            previousNibble = nibble;
+        }
+        if (!isPathChildAdded) {
+            childHashes[childHashCount++] = {pathNibble, hash};
+        }
+
+        hash = hashTrieNode(node.pathNibbles, node.valueHash, {childHashes.data(), childHashCount}, message);
+        if (hasPathChild) {
+            position -= node.pathNibbles.size() + 1;
+        }
+    }
+
+    return hash;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+bool MerklePatriciaTrie<Hasher>::putIntoNode(TrieNode &node, const std::string_view key, std::size_t position,
+                                             const hash_t &valueHash) {
+    node.isDirty = true;
+
+    if (node.isEmpty()) {
+        node.pathNibbles = getPathNibbles(key, position);
+        node.valueHash = valueHash;
+        return true;
+    }
+
+    /**
+     * If the key leaves the compressed path of the node, the node is split where it does: the upper part keeps the
+     * common nibbles and gets the lower part (with the value and the children of the node) as a child.
+     */
+    const std::size_t commonPrefixLength = getCommonPrefixLength(node.pathNibbles, key, position);
+    if (commonPrefixLength < node.pathNibbles.size()) {
+        auto lowerNode = std::make_unique<TrieNode>(std::move(node));
+        node = TrieNode();
+        node.pathNibbles = lowerNode->pathNibbles.substr(0, commonPrefixLength);
+
+        const auto lowerNodeNibble = static_cast<std::uint8_t>(lowerNode->pathNibbles[commonPrefixLength]);
+        lowerNode->pathNibbles.erase(0, commonPrefixLength + 1);
+        lowerNode->isDirty = true;
+        node.children[lowerNodeNibble] = std::move(lowerNode);
+    }
+
+    position += commonPrefixLength;
+    if (position == key.size() * 2) {
+        const bool isNewKey = !node.valueHash;
+        node.valueHash = valueHash;
+        return isNewKey;
+    }
+
+    std::unique_ptr<TrieNode> &child = node.children[getNibble(key, position)];
+    if (!child) {
+        child = std::make_unique<TrieNode>();
+        child->pathNibbles = getPathNibbles(key, position + 1);
+        child->valueHash = valueHash;
+        return true;
+    }
+
+    return putIntoNode(*child, key, position + 1, valueHash);
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+bool MerklePatriciaTrie<Hasher>::removeFromNode(TrieNode &node, const std::string_view key, std::size_t position) {
+    if (getCommonPrefixLength(node.pathNibbles, key, position) != node.pathNibbles.size()) {
+        return false;
+    }
+
+    position += node.pathNibbles.size();
+    if (position == key.size() * 2) {
+        if (!node.valueHash) {
+            return false;
+        }
+        node.valueHash.reset();
+    } else {
+        std::unique_ptr<TrieNode> &child = node.children[getNibble(key, position)];
+        if (!child || !removeFromNode(*child, key, position + 1)) {
+            return false;
+        }
+        if (child->isEmpty()) {
+            child.reset();
+        }
+    }
+
+    node.isDirty = true;
+    compressNode(node);
+    return true;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+void MerklePatriciaTrie<Hasher>::compressNode(TrieNode &node) {
+    if (node.valueHash) {
+        return;
+    }
+
+    const auto isChild = [](const auto &child) { return child != nullptr; };
+    if (std::count_if(node.children.begin(), node.children.end(), isChild) != 1) {
+        return;
+    }
+
+    const auto childIt = std::find_if(node.children.begin(), node.children.end(), isChild);
+    const std::unique_ptr<TrieNode> child = std::move(*childIt);
+
+    node.pathNibbles.push_back(static_cast<char>(childIt - node.children.begin()));
+    node.pathNibbles += child->pathNibbles;
+    node.valueHash = child->valueHash;
+    node.children = std::move(child->children);
+    node.isDirty = true;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+void MerklePatriciaTrie<Hasher>::rehashDirtyNodes(const TrieNode &node, std::string &message) {
+    if (!node.isDirty) {
+        return;
+    }
+
+    std::array<std::pair<std::uint8_t, hash_t>, childCount> childHashes;
+    std::size_t childHashCount = 0;
+    for (std::size_t nibble = 0; nibble < childCount; nibble++) {
+        if (const auto &child = node.children[nibble]) {
+            rehashDirtyNodes(*child, message);
+            childHashes[childHashCount++] = {static_cast<std::uint8_t>(nibble), child->hash};
+        }
+    }
+
+    node.hash = hashTrieNode(node.pathNibbles, node.valueHash, {childHashes.data(), childHashCount}, message);
+    node.isDirty = false;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+void MerklePatriciaTrie<Hasher>::put(const std::string_view key, const std::string_view value) {
+    if (putIntoNode(root, key, 0, hashValue(value, hashMessage))) {
+        keyCount++;
+    }
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+bool MerklePatriciaTrie<Hasher>::remove(const std::string_view key) {
+    if (!removeFromNode(root, key, 0)) {
+        return false;
+    }
+
+    keyCount--;
+    if (root.isEmpty()) {
+        root.pathNibbles.clear();
+    }
+    return true;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+void MerklePatriciaTrie<Hasher>::update(
+        const std::span<const std::pair<std::string, std::optional<std::string>>> changes) {
+    for (const auto &[key, value]: changes) {
+        if (value) {
+            put(key, *value);
+        } else {
+            remove(key);
+        }
+    }
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+std::optional<typename MerklePatriciaTrie<Hasher>::hash_t> MerklePatriciaTrie<Hasher>::get(
+        const std::string_view key) const {
+    const TrieNode *node = &root;
+    std::size_t position = 0;
+
+    while (true) {
+        if (getCommonPrefixLength(node->pathNibbles, key, position) != node->pathNibbles.size()) {
+            return std::nullopt;
+        }
+
+        position += node->pathNibbles.size();
+        if (position == key.size() * 2) {
+            return node->valueHash;
+        }
+
+        node = node->children[getNibble(key, position++)].get();
+        if (!node) {
+            return std::nullopt;
+        }
+    }
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+typename MerklePatriciaTrie<Hasher>::hash_t MerklePatriciaTrie<Hasher>::getRootHash() const {
+    rehashDirtyNodes(root, hashMessage);
+    return root.hash;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+typename MerklePatriciaTrie<Hasher>::proof_t MerklePatriciaTrie<Hasher>::generateProof(
+        const std::string_view key) const {
+    rehashDirtyNodes(root, hashMessage);
+
+    proof_t proof;
+    const TrieNode *node = &root;
+    std::size_t position = 0;
+
+    while (true) {
+        MerklePatriciaProofNode<hash_t> &proofNode = proof.nodes.emplace_back();
+        proofNode.pathNibbles = node->pathNibbles;
+        proofNode.valueHash = node->valueHash;
+
+        /**
+         * The path continues if the key goes through the whole compressed path and on to an existing child.
+         */
+        const TrieNode *nextNode = nullptr;
+        std::size_t pathNibble = childCount;
+        if (getCommonPrefixLength(node->pathNibbles, key, position) == node->pathNibbles.size()
+            && position + node->pathNibbles.size() < key.size() * 2) {
+            position += node->pathNibbles.size();
+            pathNibble = getNibble(key, position++);
+            nextNode = node->children[pathNibble].get();
+        }
+
+        for (std::size_t nibble = 0; nibble < childCount; nibble++) {
+            if (node->children[nibble] && (nibble != pathNibble || !nextNode)) {
+                proofNode.childHashes.emplace_back(static_cast<std::uint8_t>(nibble), node->children[nibble]->hash);
+            }
+        }
+
+        if (!nextNode) {
+            return proof;
+        }
+        node = nextNode;
+    }
+}
+
+template<MerkleHasher Hasher>
+bool verifyTrieInclusion(const typename Hasher::digest_type &rootHash, const std::string_view key,
+                         const std::string_view value,
+                         const MerklePatriciaProof<typename Hasher::digest_type> &proof) {
+    using Trie = MerklePatriciaTrie<Hasher>;
+
+    std::size_t terminalPosition = 0;
+    const auto computedRootHash = Trie::computeRootHash(key, proof, terminalPosition);
+    if (!computedRootHash || *computedRootHash != rootHash) {
+        return false;
+    }
+
+    /**
+     * The key has to end exactly at the end of the path of the last node, which has to have the value.
+     */
+    const MerklePatriciaProofNode<typename Hasher::digest_type> &terminalNode = proof.nodes.back();
+    std::string message;
+    return terminalNode.pathNibbles.size() == key.size() * 2 - terminalPosition
+           && Trie::getCommonPrefixLength(terminalNode.pathNibbles, key, terminalPosition)
+              == terminalNode.pathNibbles.size()
+           && terminalNode.valueHash == Trie::hashValue(value, message);
+}
+
+template<MerkleHasher Hasher>
+bool verifyTrieAbsence(const typename Hasher::digest_type &rootHash, const std::string_view key,
+                       const MerklePatriciaProof<typename Hasher::digest_type> &proof) {
+    using Trie = MerklePatriciaTrie<Hasher>;
+
+    std::size_t terminalPosition = 0;
+    const auto computedRootHash = Trie::computeRootHash(key, proof, terminalPosition);
+    if (!computedRootHash || *computedRootHash != rootHash) {
+        return false;
+    }
+
+    /**
+     * The key is absent if it leaves the path of the last node, ends at the last node without a value, or goes on to
+     * a child that the last node does not have.
+     */
+    const MerklePatriciaProofNode<typename Hasher::digest_type> &terminalNode = proof.nodes.back();
+    const std::size_t commonPrefixLength = Trie::getCommonPrefixLength(terminalNode.pathNibbles, key, terminalPosition);
+    if (commonPrefixLength != terminalNode.pathNibbles.size()) {
+        return true;
+    }
+
+    const std::size_t position = terminalPosition + terminalNode.pathNibbles.size();
+    if (position == key.size() * 2) {
+        return !terminalNode.valueHash;
+    }
+
+    const std::uint8_t nibble = Trie::getNibble(key, position);
+    return std::none_of(terminalNode.childHashes.begin(), terminalNode.childHashes.end(),
+                        [nibble](const auto &childHash) { return childHash.first == nibble; });
+}
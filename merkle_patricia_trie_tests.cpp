@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "catch2/catch_test_macros.hpp"
+#include "merkle_patricia_trie.hpp"
+
+
+TEST_CASE("MerklePatriciaTrie", "[merkle_patricia_trie]") {
+    using Trie = MerklePatriciaTrie<Sha256Hasher>;
+    std::string message;
+
+    SECTION("Empty trie has the hash of an empty root node") {
+        const Trie trie;
+        REQUIRE(trie.getRootHash() == Trie::hashTrieNode("", std::nullopt, {}, message));
+        REQUIRE(trie.getKeyCount() == 0);
+        REQUIRE_FALSE(trie.get("").has_value());
+    }
+
+    SECTION("No value has the hash of a node") {
+        const Sha256Digest nodeHash = Trie::hashTrieNode("\x01\x02", Trie::hashValue("1", message), {}, message);
+        const std::string nodeMessage = message;
+
+        REQUIRE(Trie::hashValue(nodeMessage, message) != nodeHash);
+        REQUIRE(Trie::hashValue(nodeMessage.substr(1), message) != nodeHash);
+        REQUIRE(Sha256Hasher::hashLeaf(nodeMessage) == nodeHash);
+    }
+
+    SECTION("Putting, getting and removing keys, including keys that are prefixes of each other") {
+        Trie trie;
+        const Sha256Digest emptyRootHash = trie.getRootHash();
+
+        trie.put("abc", "1");
+        trie.put("ab", "2");
+        trie.put("abd", "3");
+        trie.put("", "4");
+        trie.put("b", "5");
+
+        REQUIRE(trie.getKeyCount() == 5);
+        REQUIRE(trie.get("abc") == Trie::hashValue("1", message));
+        REQUIRE(trie.get("ab") == Trie::hashValue("2", message));
+        REQUIRE(trie.get("abd") == Trie::hashValue("3", message));
+        REQUIRE(trie.get("") == Trie::hashValue("4", message));
+        REQUIRE(trie.get("b") == Trie::hashValue("5", message));
+        REQUIRE_FALSE(trie.get("a").has_value());
+        REQUIRE_FALSE(trie.get("abcd").has_value());
+
+        trie.put("ab", "6");
+        REQUIRE(trie.get("ab") == Trie::hashValue("6", message));
+        REQUIRE(trie.getKeyCount() == 5);
+
+        REQUIRE_FALSE(trie.remove("a"));
+        for (const char *key: {"abc", "ab", "abd", "", "b"}) {
+            REQUIRE(trie.remove(key));
+            REQUIRE_FALSE(trie.get(key).has_value());
+        }
+
+        REQUIRE(trie.getKeyCount() == 0);
+        REQUIRE(trie.getRootHash() == emptyRootHash);
+    }
+
+    SECTION("Root hash only depends on the keys and values, not on the order of changes") {
+        std::vector<std::string> keys;
+        for (int i = 0; i < 300; i++) {
+            keys.push_back("key " + std::to_string(i));
+        }
+
+        Trie forwards, shuffled;
+        for (const std::string &key: keys) {
+            forwards.put(key, "value of " + key);
+        }
+
+        std::mt19937 random(5);
+        std::shuffle(keys.begin(), keys.end(), random);
+        for (const std::string &key: keys) {
+            shuffled.put(key, "value of " + key);
+            shuffled.put(key + " extra", "value");
+        }
+        for (const std::string &key: keys) {
+            REQUIRE(shuffled.remove(key + " extra"));
+        }
+
+        REQUIRE(shuffled.getKeyCount() == 300);
+        REQUIRE(shuffled.getRootHash() == forwards.getRootHash());
+    }
+
+    SECTION("Root hash is updated when it is read between changes") {
+        Trie readInBetween, readAtTheEnd;
+        for (int i = 0; i < 100; i++) {
+            readInBetween.put(std::to_string(i), "value");
+            readAtTheEnd.put(std::to_string(i), "value");
+            (void) readInBetween.getRootHash();
+        }
+        for (int i = 0; i < 100; i += 3) {
+            readInBetween.remove(std::to_string(i));
+            readAtTheEnd.remove(std::to_string(i));
+            (void) readInBetween.getRootHash();
+        }
+
+        REQUIRE(readInBetween.getRootHash() == readAtTheEnd.getRootHash());
+    }
+
+    SECTION("Batch update gives the same trie as individual changes") {
+        std::vector<std::pair<std::string, std::optional<std::string>>> changes;
+        Trie oneByOne, batched;
+
+        for (int i = 0; i < 200; i++) {
+            changes.emplace_back("key " + std::to_string(i % 150), "value " + std::to_string(i));
+            if (i % 7 == 0) {
+                changes.emplace_back("key " + std::to_string(i / 2), std::nullopt);
+            }
+        }
+
+        for (const auto &[key, value]: changes) {
+            if (value) {
+                oneByOne.put(key, *value);
+            } else {
+                oneByOne.remove(key);
+            }
+        }
+        batched.update(changes);
+
+        REQUIRE(batched.getKeyCount() == oneByOne.getKeyCount());
+        REQUIRE(batched.getRootHash() == oneByOne.getRootHash());
+    }
+
+    SECTION("Proofs of inclusion and absence") {
+        Trie trie;
+        for (int i = 0; i < 1000; i++) {
+            trie.put("key " + std::to_string(i), "value " + std::to_string(i));
+        }
+        trie.put("z1", "value");
+        trie.put("zA", "value");
+        const Sha256Digest rootHash = trie.getRootHash();
+
+        for (int i = 0; i < 1000; i++) {
+            const std::string key = "key " + std::to_string(i);
+            const auto proof = trie.generateProof(key);
+
+            REQUIRE(proof.nodes.size() <= key.size() * 2 + 1);
+            REQUIRE(verifyTrieInclusion<Sha256Hasher>(rootHash, key, "value " + std::to_string(i), proof));
+            REQUIRE_FALSE(verifyTrieInclusion<Sha256Hasher>(rootHash, key, "other value", proof));
+            REQUIRE_FALSE(verifyTrieAbsence<Sha256Hasher>(rootHash, key, proof));
+        }
+
+        /**
+         * Absent keys leave the trie in the middle of a compressed path ("ke", "kex", "x"), end at a node without a
+         * value ("", "z") or go on to a missing child ("key 1000", "key 9a").
+         */
+        for (const std::string key: {"", "ke", "kex", "x", "z", "key 1000", "key 9a"}) {
+            const auto proof = trie.generateProof(key);
+            REQUIRE(verifyTrieAbsence<Sha256Hasher>(rootHash, key, proof));
+            REQUIRE_FALSE(verifyTrieInclusion<Sha256Hasher>(rootHash, key, "value", proof));
+        }
+    }
+
+    SECTION("Tampered proofs are rejected") {
+        Trie trie;
+        for (int i = 0; i < 100; i++) {
+            trie.put("key " + std::to_string(i), "value " + std::to_string(i));
+        }
+        const Sha256Digest rootHash = trie.getRootHash();
+
+        auto proof = trie.generateProof("key 42");
+        proof.nodes.front().childHashes.front().second[0] ^= 1;
+        REQUIRE_FALSE(verifyTrieInclusion<Sha256Hasher>(rootHash, "key 42", "value 42", proof));
+
+        /**
+         * Dropping the value or the child on the path does not make a present key absent.
+         */
+        proof = trie.generateProof("key 42");
+        proof.nodes.back().valueHash.reset();
+        REQUIRE_FALSE(verifyTrieAbsence<Sha256Hasher>(rootHash, "key 42", proof));
+
+        proof = trie.generateProof("key 42");
+        proof.nodes.pop_back();
+        REQUIRE_FALSE(verifyTrieAbsence<Sha256Hasher>(rootHash, "key 42", proof));
+
+        /**
+         * Nor does moving a child hash to another nibble (the child hashes have to stay sorted).
+         */
+        proof = trie.generateProof("key 4:");
+        auto &childHashes = proof.nodes.back().childHashes;
+        REQUIRE(childHashes.size() >= 2);
+        std::swap(childHashes[0].second, childHashes[1].second);
+        REQUIRE_FALSE(verifyTrieAbsence<Sha256Hasher>(rootHash, "key 4:", proof));
+        std::swap(childHashes[0], childHashes[1]);
+        REQUIRE_FALSE(verifyTrieAbsence<Sha256Hasher>(rootHash, "key 4:", proof));
+
+        REQUIRE_FALSE(verifyTrieAbsence<Sha256Hasher>(rootHash, "key 4:", MerklePatriciaProof<Sha256Digest>{}));
+    }
+
+    SECTION("Works with the default hasher") {
+        MerklePatriciaTrie trie;
+        trie.put("a", "1");
+        trie.put("b", "2");
+
+        REQUIRE(verifyTrieInclusion(trie.getRootHash(), "a", "1", trie.generateProof("a")));
+        REQUIRE(verifyTrieAbsence(trie.getRootHash(), "c", trie.generateProof("c")));
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "merkle_tree_hashers.hpp"
+
+
+/**
+ * Computes the root hash of a Merkle tree from a stream of data without storing the tree. The root hash is the same as
+ * `MerkleTree<Hasher>::getRootHash` gives for the same data added in the same order.
+ *
+ * Only the frontier of the tree is kept: the roots of the complete subtrees that the leaves added so far form, at most
+ * one per level (one for every bit that is set in the number of leaves). Adding a leaf merges it with the subtrees of
+ * the same size, like adding 1 to a binary counter, so memory use is O(log n) and the amortized cost of adding a leaf is
+ * a constant number of hashes.
+ */
+template<MerkleHasher Hasher = StdHasher>
+struct MerkleStreamBuilder {
+
+public:
+
+    using hash_t = typename Hasher::digest_type;
+
+private:
+
+    /**
+     * frontier[level] is the root of the complete subtree of 2^level leaves that ends the stream so far, if the bit
+     * `level` of `currentTreeSize` is set (otherwise the value is unused).
+     */
+    std::vector<hash_t> frontier;
+
+    std::uint64_t currentTreeSize = 0;
+
+public:
+
+    /**
+     * Add the hash of the given data as the next leaf.
+     */
+    void addHashOf(std::string_view data);
+
+    /**
+     * Add a leaf hash, as computed by Hasher::hashLeaf, as the next leaf.
+     */
+    void addLeafHash(const hash_t &leafHash);
+
+    /**
+     * Get the root hash of the tree spanned by the leaves added so far, with the same unbalanced shape as MerkleTree
+     * (see `MerkleTree::addHashOf`). This takes O(log n) hashes and does not change the state of the builder, so more
+     * leaves can be added afterwards.
+     *
+     * @throws MerkleTreeEmptyException if no leaves have been added
+     */
+    [[nodiscard]] hash_t getRootHash() const;
+
+    [[nodiscard]] std::uint64_t getTreeSize() const noexcept {
+        return currentTreeSize;
+    }
+};
+
+
+#include "merkle_stream_builder.tpp"
@@ -0,0 +1,56 @@
+#pragma once
+#include <bit>
+#include "merkle_tree_exceptions.hpp"
+
+
+template<MerkleHasher Hasher>
+void MerkleStreamBuilder<Hasher>::addHashOf(const std::string_view data) {
+    addLeafHash(Hasher::hashLeaf(data));
+}
+
+template<MerkleHasher Hasher>
+void MerkleStreamBuilder<Hasher>::addLeafHash(const hash_t &leafHash) {
+    /**
+     * The new leaf is a complete subtree of height 0. As long as there is a complete subtree of the same height on the
+     * frontier, the two are its left and right halves, so they are merged into a subtree one level higher.
+     */
+    hash_t subtreeHash = leafHash;
+    std::size_t level = 0;
+
+    for (; (currentTreeSize >> level) & 1; level++) {
+        subtreeHash = Hasher::hashNode(frontier[level], subtreeHash);
+    }
+
+    if (level == frontier.size()) {
+        frontier.push_back(subtreeHash);
+    } else {
+        frontier[level] = subtreeHash;
+    }
+
+    currentTreeSize++;
+}
+
+template<MerkleHasher Hasher>
+typename MerkleStreamBuilder<Hasher>::hash_t MerkleStreamBuilder<Hasher>::getRootHash() const {
+    if (currentTreeSize == 0) {
+        throw MerkleTreeEmptyException();
+    }
+
+    /**
+     * Fold the frontier into the root from the bottom up. The subtrees of the frontier are exactly the complete subtrees
+     * that the right edge of the tree is split into: every node on the right edge has a frontier subtree as its left
+     * child and the rest of the edge as its right child, and a node without a right child is the same as its left child.
+     * So the root is the smallest frontier subtree, combined with each larger one on its left in turn. A power of two
+     * leaves forms a single complete subtree, which is the whole tree.
+     */
+    std::size_t level = static_cast<std::size_t>(std::countr_zero(currentTreeSize));
+    hash_t rootHash = frontier[level];
+
+    for (level++; level < frontier.size(); level++) {
+        if ((currentTreeSize >> level) & 1) {
+            rootHash = Hasher::hashNode(frontier[level], rootHash);
+        }
+    }
+
+    return rootHash;
+}
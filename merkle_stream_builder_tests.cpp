@@ -0,0 +1,37 @@
+#include <string>
+#include "catch2/catch_test_macros.hpp"
+#include "merkle_stream_builder.hpp"
+#include "merkle_tree.hpp"
+
+
+TEST_CASE("MerkleStreamBuilder", "[merkle_stream_builder]") {
+    SECTION("Taking root hash of empty stream throws exception") {
+        const MerkleStreamBuilder builder;
+        REQUIRE_THROWS_AS(builder.getRootHash(), MerkleTreeEmptyException);
+    }
+
+    SECTION("Root hash matches the root hash of a MerkleTree for {1, 2, ..., 130} leaves") {
+        MerkleStreamBuilder builder;
+        MerkleTree tree;
+
+        for (int i = 0; i < 130; i++) {
+            builder.addHashOf("data " + std::to_string(i));
+            tree.addHashOf("data " + std::to_string(i));
+
+            REQUIRE(builder.getTreeSize() == tree.getTreeSize());
+            REQUIRE(builder.getRootHash() == tree.getRootHash());
+        }
+    }
+
+    SECTION("Root hash matches the root hash of a MerkleTree with SHA-256") {
+        MerkleStreamBuilder<Sha256Hasher> builder;
+        MerkleTree<Sha256Hasher> tree;
+
+        for (int i = 0; i < 70; i++) {
+            builder.addHashOf("data " + std::to_string(i));
+            tree.addHashOf("data " + std::to_string(i));
+
+            REQUIRE(builder.getRootHash() == tree.getRootHash());
+        }
+    }
+}
@@ -1,25 +1,184 @@
 #pragma once
-#include <array>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "merkle_tree_file.hpp"
+#include "merkle_tree_hashers.hpp"
 
 
 /**
- * The height of the tree
+ * The largest height a tree can grow to. Capacity doubles with each level, so a tree of height h can hold 2^h hashes
+ * and 2^maxTreeHeight is the largest power of two that still fits into std::size_t.
  */
-static constexpr int treeHeight = 5;
+static constexpr std::size_t maxTreeHeight = std::numeric_limits<std::size_t>::digits - 1;
 
 /**
- * Capacity doubles with each level, so the total capacity of the tree is 2^TREE_HEIGHT.
+ * A proof that a leaf node of a Merkle tree has a given hash, generated by `MerkleTree::generateProof` and checked
+ * with `verifyProof`.
+ */
+template<typename Digest>
+struct MerkleProof {
+    /**
+     * Index of the leaf node. Its bits tell, for each level, whether the node on the path to the root node is a left
+     * (bit is 0) or a right (bit is 1) child, i.e. which side its sibling hash has to be combined from.
+     */
+    std::size_t leafNodeIndex = 0;
+
+    /**
+     * Number of hashes in the tree. Together with the index, it tells on which levels the path node is the last node
+     * of a level without a right sibling, i.e. on which levels there is no sibling hash.
+     */
+    std::size_t treeSize = 0;
+
+    /**
+     * Hashes of the sibling nodes on the path from the leaf node to the root node, starting with the leaf node's sibling.
+     * There are at most ceil(log2(treeSize)) of them.
+     */
+    std::vector<Digest> siblingHashes;
+};
+
+/**
+ * A proof that the tree with `oldTreeSize` hashes is a prefix of the tree with `newTreeSize` hashes, i.e. that the
+ * newer tree was made by only appending hashes to the older one. Generated by `MerkleTree::generateConsistencyProof`
+ * and checked with `verifyConsistency`.
  *
- * To get 2^TREE_HEIGHT, shift the binary representation of the decimal value 1 to the left by TREE_HEIGHT bits.
- * For example, if TREE_HEIGHT is 5, then 00000001 << 5 = 00100000 = 32.
+ * The proof is the inclusion proof of the last leaf of the older tree in the newer tree, along with the hash of that
+ * leaf. The siblings on the left of the path cover all the other leaves of the older tree and appear in both trees,
+ * the siblings on the right only appear in the newer tree (in the older tree, there are no leaves to their right).
+ */
+template<typename Digest>
+struct MerkleConsistencyProof {
+    std::size_t oldTreeSize = 0;
+
+    std::size_t newTreeSize = 0;
+
+    /**
+     * Hash of the leaf node at index oldTreeSize - 1.
+     */
+    Digest lastOldLeafHash{};
+
+    /**
+     * Hashes of the sibling nodes on the path from that leaf node to the root node of the newer tree.
+     */
+    std::vector<Digest> siblingHashes;
+};
+
+/**
+ * A proof that several leaf nodes of a Merkle tree have the given hashes, generated by `MerkleTree::generateMultiProof`
+ * and checked with `verifyMultiProof`. The paths of the leaf nodes to the root node share most of their upper nodes, so
+ * instead of a full path per leaf, the proof only has the hashes of the nodes that cannot be computed from the leaves
+ * themselves: on every level, the siblings of the path nodes that are not path nodes themselves (and exist at all, see
+ * MerkleProof::treeSize).
+ */
+template<typename Digest>
+struct MerkleMultiProof {
+    /**
+     * Number of hashes in the tree, which determines its height.
+     */
+    std::size_t treeSize = 0;
+
+    /**
+     * Indexes of the leaf nodes, sorted and without duplicates.
+     */
+    std::vector<std::size_t> leafNodeIndexes;
+
+    /**
+     * Hashes of the sibling nodes, level by level from the leaves up and from left to right within a level.
+     */
+    std::vector<Digest> siblingHashes;
+};
+
+/**
+ * A proof that a contiguous range of leaf nodes of a Merkle tree has the given hashes, generated by
+ * `MerkleTree::generateRangeProof` and checked with `verifyRangeProof`. The subtree spanned by the range is rebuilt from
+ * the leaves themselves, so the only hashes needed are the ones just outside of the range on each level: the left
+ * boundary path and the right boundary path, at most two hashes per level.
  */
-static constexpr int treeCapacity = 1 << treeHeight;
+template<typename Digest>
+struct MerkleRangeProof {
+    /**
+     * Number of hashes in the tree, which determines its height.
+     */
+    std::size_t treeSize = 0;
+
+    std::size_t firstLeafNodeIndex = 0;
+
+    std::size_t leafCount = 0;
+
+    /**
+     * Hashes of the nodes directly to the left of the range on the levels where the range starts with a right child,
+     * from the leaves up.
+     */
+    std::vector<Digest> leftSiblingHashes;
+
+    /**
+     * Hashes of the nodes directly to the right of the range on the levels where the range ends with a left child
+     * that is not the last node of its level, from the leaves up.
+     */
+    std::vector<Digest> rightSiblingHashes;
+};
+
+/**
+ * Hash and proof types of a MerkleTree using the default hash function policy (see MerkleTree<Hasher>::hash_t).
+ */
+using hash_t = StdHasher::digest_type;
+using proof_t = MerkleProof<hash_t>;
+using consistency_proof_t = MerkleConsistencyProof<hash_t>;
+using multi_proof_t = MerkleMultiProof<hash_t>;
+using range_proof_t = MerkleRangeProof<hash_t>;
+
+/**
+ * Settings used when creating a MerkleTree. The defaults give an empty tree that grows as much as needed.
+ */
+struct MerkleTreeOptions {
+    /**
+     * Height of the tree upon creation, i.e. room for 2^initialHeight hashes is allocated up front. The tree grows
+     * automatically once it is full, so this only saves reallocations when the number of hashes is known in advance.
+     * It does not affect the root hash or the proofs.
+     */
+    std::size_t initialHeight = 0;
 
-using hash_t = std::size_t;
-using proof_t = std::array<hash_t, treeHeight>;
+    /**
+     * Height past which the tree is not allowed to grow. Must not be smaller than `initialHeight` or greater than
+     * `maxTreeHeight`.
+     */
+    std::size_t maxHeight = maxTreeHeight;
+
+    /**
+     * Number of threads used for rebuilding the tree after large batches of hashes are added (see `addHashesOf`).
+     * 0 means one thread per hardware thread, as reported by std::thread::hardware_concurrency().
+     */
+    std::size_t threadCount = 1;
+
+    /**
+     * If true, `addHashOf`, `addHashesOf`, `updateLeaf` and `updateLeaves` only store the new leaf hashes and mark their
+     * ancestors as dirty; the dirty nodes are rehashed the next time the root hash or a proof is requested. Every dirty
+     * node is rehashed once no matter how many of its leaves changed in the meantime, so bursts of writes between reads
+     * are much cheaper. Note that reading then modifies the tree, so concurrent reads need to be synchronized as well.
+     */
+    bool lazyRootUpdates = false;
+};
 
+/**
+ * A Merkle tree whose hashes are computed with the hash function policy `Hasher` (see MerkleHasher).
+ */
+template<MerkleHasher Hasher = StdHasher>
 struct MerkleTree {
 
+public:
+
+    using hash_t = typename Hasher::digest_type;
+    using proof_t = MerkleProof<hash_t>;
+    using consistency_proof_t = MerkleConsistencyProof<hash_t>;
+    using multi_proof_t = MerkleMultiProof<hash_t>;
+    using range_proof_t = MerkleRangeProof<hash_t>;
+
 private:
 
     /**
@@ -32,7 +191,9 @@ private:
      */
     struct MerkleNode {
         /**
-         * Level of the node. The root node is on level 0, its children are on level 1, etc.
+         * Level of the node, counted from the bottom: the leaf nodes are on level 0, their parents are on level 1,
+         * etc. Counting from the bottom means that the level of a node does not change when the tree grows a new
+         * root level on top of the current root.
          */
         std::size_t level;
 
@@ -53,7 +214,7 @@ private:
          * any children), false otherwise.
          */
         [[nodiscard]] bool isLeaf() const noexcept {
-            return level == treeHeight;
+            return level == 0;
         }
 
         /**
@@ -62,18 +223,18 @@ private:
         [[nodiscard]] MerkleNode getSiblingNode() const noexcept;
 
         /**
-         * Find the path from this (leaf) node to the root node of the tree.
-         * @return std::array of MerkleNode structs [n_1, n_2, ..., n_k] (k = TREE_HEIGHT) where n_1 is this node and
-         * n_2 is its parent, n_3 is the parent of n_2, etc. The last node of the array, n_k, is a child of the root node.
+         * @return the parent node, i.e. the node that is one level above this node and has this node as a child.
          */
-        [[nodiscard]] std::array<MerkleNode, treeHeight> getPathFromLeafToRoot() const noexcept;
+        [[nodiscard]] MerkleNode getParentNode() const noexcept {
+            return {level + 1, index / 2};
+        }
 
         /**
          * @return the left child of this node, i.e. the node that is one level below this node and, out of the
          * indexes of this node's children (2 * index and 2 * index + 1), has the former.
          */
         [[nodiscard]] MerkleNode getLeftChild() const noexcept {
-            return {level + 1, 2 * index};
+            return {level - 1, 2 * index};
         }
 
         /**
@@ -81,23 +242,144 @@ private:
          * indexes of this node's children (2 * index and 2 * index + 1), has the latter.
          */
         [[nodiscard]] MerkleNode getRightChild() const noexcept {
-            return {level + 1, 2 * index + 1};
+            return {level - 1, 2 * index + 1};
         }
     };
 
     /**
-     * Calculate the hash of a given node. The hash of a leaf node is the hash of the data that was inserted into it
-     * and the hash of a non-leaf node is the hash of the sum of its children's hashes, found recursively.
+     * Look up the hash of a given node. The hash of a leaf node is the hash of the data that was inserted into it
+     * and the hash of a non-leaf node is the hash of its children's hashes combined. Both are stored in the tree,
+     * so this is a constant time lookup rather than a recursive computation.
      *
      * @return hash of the given node
      */
     [[nodiscard]] hash_t getNodeHash(const MerkleNode &node) const noexcept;
 
     /**
-     * @return true if the tree is full, false otherwise.
+     * @return the position of the given node in `nodeHashes` (see there for the layout).
+     */
+    [[nodiscard]] std::size_t getNodePosition(const MerkleNode &node) const noexcept {
+        return (std::size_t{1} << (storageHeight - node.level)) + node.index;
+    }
+
+    /**
+     * @return the stored hashes of all the nodes on the given level, a contiguous part of `nodeHashes`.
+     */
+    [[nodiscard]] std::span<hash_t> getLevelHashes(const std::size_t level) const noexcept {
+        const std::size_t levelSize = std::size_t{1} << (storageHeight - level);
+        return std::span(nodeHashes).subspan(levelSize, levelSize);
+    }
+
+    /**
+     * Recompute the stored hashes of all the ancestors of the given leaf node, starting from its parent and ending
+     * with the topmost stored node. Only the nodes on this path depend on the leaf, so the rest of the tree is left
+     * untouched.
+     */
+    void updatePathToRoot(const MerkleNode &leafNode) noexcept;
+
+    /**
+     * @return true if the right child of the given node (level > 0) has no leaves in a tree of the given size, in which
+     * case the node has the same hash as its left child (see `addHashOf`).
+     */
+    [[nodiscard]] static bool hasEmptyRightChild(const MerkleNode &node, const std::size_t treeSize) noexcept {
+        return node.getRightChild().index << (node.level - 1) >= treeSize;
+    }
+
+    /**
+     * Recompute the stored hash of the given node (level > 0) from the stored hashes of its children.
+     */
+    void rehashNode(const MerkleNode &node) const noexcept;
+
+    /**
+     * Hashes of the tree as it was when it had `treeSize` hashes (at most the current size), which the stored hashes
+     * are not enough for: since then, hashes were added to the leaves that were empty, so the nodes on the right edge of
+     * the older tree (the ancestors of its last leaf that were not complete yet) have changed.
+     *
+     * `incompleteNodeHashes[level]` is the hash that the incomplete node on that level had, up to the height of the
+     * older tree. The remaining nodes of the older tree still have the stored hash (all of their leaves were in it).
+     */
+    struct HistoricalHashes {
+        std::size_t treeSize;
+        std::vector<hash_t> incompleteNodeHashes;
+    };
+
+    /**
+     * Compute the hashes of the incomplete nodes of the tree as it was when it had `treeSize` hashes, from the bottom up,
+     * in O(log n) time.
+     */
+    [[nodiscard]] HistoricalHashes getHistoricalHashes(std::size_t treeSize) const;
+
+    /**
+     * @return the hash that the given node had when the tree had `historicalHashes.treeSize` hashes. The node must have
+     * had at least one leaf then.
+     */
+    [[nodiscard]] hash_t getHistoricalNodeHash(const MerkleNode &node,
+                                               const HistoricalHashes &historicalHashes) const noexcept;
+
+    /**
+     * Recompute the stored hashes of the given nodes on the given level (> 0) from their children, hashing all the child
+     * pairs with a single `hashNodePairs` call. The indexes must be sorted and unique.
+     */
+    void rehashNodes(std::size_t level, std::span<const std::size_t> nodeIndexes) const;
+
+    /**
+     * In lazy mode, mark all the ancestors of the given leaf node as dirty. The walk stops at the first ancestor that is
+     * already dirty, since its own ancestors have been marked when it was.
+     */
+    void markPathDirty(const MerkleNode &leafNode) noexcept;
+
+    /**
+     * Rehash all the dirty nodes (see MerkleTreeOptions::lazyRootUpdates) level by level, starting from the bottom, and
+     * update the root hash. Does nothing if there are no dirty nodes, in particular if the tree is not in lazy mode.
+     */
+    void rehashDirtyNodes() const;
+
+    /**
+     * Recompute the stored hashes of all the ancestors of the nodes [firstIndex, lastIndex) on the given level, up to
+     * and including the ancestors on level topLevel. The ancestors of a contiguous range of nodes form a contiguous range
+     * on every level, so each of them is rehashed exactly once, no matter how many of the given nodes it is an ancestor of.
+     */
+    void updateLevels(std::size_t level, std::size_t firstIndex, std::size_t lastIndex, std::size_t topLevel) noexcept;
+
+    /**
+     * Fill in the leaf nodes [firstLeafIndex, lastLeafIndex) by calling hashLeafNodes(first, last) on sub-ranges of it
+     * and then recompute the hashes of all their ancestors.
+     *
+     * Large ranges are split into chunks of whole subtrees that are handed out to `threadCount` threads. Each thread
+     * hashes the leaves of its chunks and builds the subtrees on top of them, after which the few remaining levels
+     * above the subtrees are built on the calling thread.
+     */
+    void buildFromLeaves(std::size_t firstLeafIndex, std::size_t lastLeafIndex,
+                         const std::function<void(std::size_t, std::size_t)> &hashLeafNodes);
+
+    /**
+     * The smallest number of leaves per thread for which `buildFromLeaves` starts additional threads. Below this,
+     * the cost of starting a thread is comparable to the cost of hashing the leaves.
+     */
+    static constexpr std::size_t minLeavesPerThread = 1024;
+
+    /**
+     * Double the capacity of the tree by adding a new root level on top of the current topmost stored node.
+     * @throws MerkleTreeFullException if the tree is already at its maximum height
+     */
+    void grow();
+
+    /**
+     * Grow the tree until it has room for the given number of hashes.
+     * @throws MerkleTreeFullException if the tree would have to grow past its maximum height (the tree is not modified)
+     */
+    void reserveCapacity(std::size_t treeSize);
+
+    /**
+     * @return the height of the smallest tree that can hold the given number of hashes, i.e. ceil(log2(treeSize)).
+     */
+    [[nodiscard]] static std::size_t getHeightForSize(std::size_t treeSize) noexcept;
+
+    /**
+     * @return true if there is no more room for hashes without growing the tree, false otherwise.
      */
     [[nodiscard]] bool isFull() const noexcept {
-        return currentTreeSize == treeCapacity;
+        return currentTreeSize == std::size_t{1} << storageHeight;
     }
 
     /**
@@ -111,41 +393,106 @@ private:
      * The initial root hash is overwritten as soon as the first data node is inserted. Before this, trying to query
      * the root hash will throw an exception (see getRootHash), so this value will never be seen by the user of the tree.
      */
-    hash_t currentRootHash = 0;
+    mutable hash_t currentRootHash{};
 
     std::size_t currentTreeSize = 0;
 
+    std::size_t maxHeight = maxTreeHeight;
+
+    std::size_t threadCount = 1;
+
+    bool lazyRootUpdates = false;
+
     /**
-     * For the leaf nodes, an initial value of 0 is used as a placeholder. This is something that won't be visible
-     * from the outside and should not concern the user of the tree.
-     *
-     * The placeholder value works since a parent node's hash is calculated as a hash of the sum of its children's
-     * hashes and thus a child's hash of 0 will not affect the parent's hash until it is replaced with a real value.
+     * In lazy mode, dirtyNodes[level] is a bitmap with a bit for every node on that level (> 0), set if the node's
+     * stored hash is out of date because some of its leaves have changed since it was last hashed. Empty otherwise.
+     */
+    mutable std::vector<std::vector<std::uint64_t>> dirtyNodes;
+
+    mutable bool hasDirtyNodes = false;
+
+    /**
+     * Height of the stored tree, i.e. the stored tree has room for 2^storageHeight hashes.
+     */
+    std::size_t storageHeight = 0;
+
+    /**
+     * Hashes of all the nodes of the tree in a single contiguous buffer, in heap order: the topmost stored node is at
+     * position 1 and the children of the node at position p are at positions 2p and 2p + 1 (position 0 is unused). Every
+     * level is a contiguous range (see `getLevelHashes`), so the hashes of node pairs can be read and written in bulk,
+     * and the levels near the top, which every proof and every update goes through, share a few cache lines instead of
+     * each living in a separate allocation. Keeping the hashes of the non-leaf nodes around means that inserting a leaf
+     * only has to rehash the ancestors of that leaf instead of the whole tree. The hashes are mutable because, in lazy
+     * mode, the dirty ones are only brought up to date when they are read.
      *
-     * For example, if the right child of a node is empty (has a hash of 0) and the left child has a real value,
-     * the hash of the parent node will be H(left_child + 0) = H(left_child) i.e. the hash depends only on the one
-     * child that does have a real, non-zero value.
+     * The nodes without any leaves yet hold a value-initialized hash_t, which is never read: empty nodes take no part in
+     * the hashing (see `addHashOf`), so they cannot be confused with nodes that do have leaves.
      *
-     * It is technically possible for a collision to occur (i.e. some newly inserted data could get a hash of 0) but,
-     * in order to abuse this, an attacker would need to find a preimage for a specific value which is considered to be
-     * infeasible for most hash functions (more so for cryptographic hashes, if one was to be used instead of std::hash).
+     * The stored tree may be taller than needed for the current number of hashes (see MerkleTreeOptions::initialHeight).
+     * The root node of the tree is always the node at level getTreeHeight(), index 0, so that the root hash only
+     * depends on the inserted hashes and not on how much room happens to be allocated.
      */
-    std::array<hash_t, treeCapacity> treeLeafNodes = {};
+    mutable std::vector<hash_t> nodeHashes;
 
 
 public:
 
     /**
-     * The tree has a capacity of 2^TREE_HEIGHT elements and is empty upon creation. Note that this Merkle tree does
-     * not store the original data in its leaf nodes, only the hashes of the data.
+     * The tree is empty upon creation and grows (doubles its capacity) whenever a hash is added to a full tree. Note
+     * that this Merkle tree does not store the original data in its leaf nodes, only the hashes of the data.
+     *
+     * @throws MerkleTreeHeightOutOfRangeException if the heights in the options are out of range
      */
-    MerkleTree() = default;
+    explicit MerkleTree(const MerkleTreeOptions &options = {});
 
     /**
      * Insert a data hash into the tree, 0-indexed: the first added hash is at index 0, the second at index 1, etc.
-     * @throws MerkleTreeFullException if the tree is full
+     *
+     * The tree has the unbalanced shape of RFC 6962: a node whose right child has no leaves (which only happens on the
+     * right edge of a tree whose size is not a power of two) is not hashed, it simply takes the hash of its left child.
+     * Equivalently, a tree of n > 1 hashes is the complete tree of the first 2^k hashes (the largest 2^k < n) on the
+     * left and the tree of the remaining n - 2^k hashes on the right. Empty leaves are never hashed and proofs only
+     * have hashes for the siblings that exist, ceil(log2(n)) at most.
+     *
+     * @throws MerkleTreeFullException if the tree is full and already at its maximum height
+     */
+    void addHashOf(std::string_view data);
+
+    /**
+     * Insert the hashes of all the given data into the tree, in order, as if `addHashOf` was called for each of them.
+     * The leaves are hashed first and the affected non-leaf nodes are then rebuilt level by level, so every node is
+     * hashed at most once per call and the root hash is only updated at the end. Large batches are hashed in parallel
+     * if the tree was created with a `MerkleTreeOptions::threadCount` other than 1. In lazy mode (see
+     * `MerkleTreeOptions::lazyRootUpdates`), only the leaves are hashed and their ancestors are marked dirty.
+     *
+     * @throws MerkleTreeFullException if the hashes do not fit into a tree of the maximum height (the tree is not modified)
      */
-    void addHashOf(const std::string &data);
+    void addHashesOf(std::span<const std::string> data);
+
+    /**
+     * Same as above, for data given as a range of anything convertible to std::string_view.
+     * @throws MerkleTreeFullException if the hashes do not fit into a tree of the maximum height (the tree is not modified)
+     */
+    template<std::forward_iterator Iterator>
+    void addHashesOf(Iterator first, Iterator last);
+
+    /**
+     * Replace the hash at the given index (0-indexed, described in `addHashOf`) with the hash of the given data. Only
+     * the ancestors of the leaf are rehashed, so this takes getTreeHeight() hashes, just like adding a hash.
+     *
+     * @throws MerkleNodeIndexOutOfRangeException if the index is out of range (greater than or equal to the tree size)
+     */
+    void updateLeaf(std::size_t leafNodeIndex, std::string_view data);
+
+    /**
+     * Replace many hashes at once, as if `updateLeaf` was called for each (index, data) pair in order (so if an index
+     * appears more than once, the last one wins). The ancestors of the updated leaves are rehashed level by level and
+     * ancestors shared by several updated leaves are rehashed only once, so updates that are close together cost little
+     * more than a single one.
+     *
+     * @throws MerkleNodeIndexOutOfRangeException if any of the indexes is out of range (the tree is not modified)
+     */
+    void updateLeaves(std::span<const std::pair<std::size_t, std::string>> updates);
 
     /**
      * Get the root hash of the tree. The value changes (modulo hash collisions) whenever new hashes are inserted.
@@ -153,24 +500,182 @@ public:
      */
     [[nodiscard]] hash_t getRootHash() const;
 
+    /**
+     * Get the root hash that the tree had when it held its first `treeSize` hashes. Nothing is stored per version:
+     * since hashes are only ever appended, every subtree that was complete at that size still has the same stored
+     * hash, and the O(log n) nodes on the right edge of the older tree are recomputed from them.
+     *
+     * Replacing a hash (`updateLeaf`, `updateLeaves`) rewrites the history of all the sizes that include it, so
+     * afterwards this returns the root hash of the first `treeSize` hashes as they are now.
+     *
+     * @throws MerkleTreeEmptyException if treeSize is 0
+     * @throws MerkleTreeSizeOutOfRangeException if treeSize is greater than the current tree size
+     */
+    [[nodiscard]] hash_t getRootHash(std::size_t treeSize) const;
+
+    /**
+     * @return the number of hashes in the tree.
+     */
+    [[nodiscard]] std::size_t getTreeSize() const noexcept {
+        return currentTreeSize;
+    }
+
+    /**
+     * @return the height of the tree spanned by the hashes currently in the tree, i.e. the number of hashes in a proof.
+     */
+    [[nodiscard]] std::size_t getTreeHeight() const noexcept {
+        return getHeightForSize(currentTreeSize);
+    }
+
     /**
      * Generate a proof for a given index (0-indexed, described in `addHashOf`), to be used in the `verifyProof` function.
      * The proof produced is completely independent of the tree in that it can be verified even without knowing anything
      * about the tree other than the root node.
      *
-     * @return proof_t containing the hashes of the sibling nodes on the path from the leaf node to the root node.
-     * @throws MerkleNodeIndexOutOfRangeException if the index is out of range (greater than or equal to TREE_CAPACITY)
+     * All the sibling hashes are read from the stored levels of the tree, so generating a proof takes getTreeHeight()
+     * lookups regardless of how many hashes the tree holds.
+     *
+     * @return proof_t containing the index of the leaf node and the hashes of the sibling nodes on the path from the
+     * leaf node to the root node.
+     * @throws MerkleNodeIndexOutOfRangeException if the index is out of range (greater than or equal to the tree size)
      * @throws MerkleTreeEmptyException if the tree is empty
      */
     [[nodiscard]] proof_t generateProof(std::size_t leafNodeIndex) const;
+
+    /**
+     * Generate a proof for a given index against the root hash that the tree had when it held its first `treeSize`
+     * hashes, i.e. against `getRootHash(treeSize)`. Takes O(log n) time, see `getRootHash(std::size_t)`.
+     *
+     * @throws MerkleNodeIndexOutOfRangeException if the index is out of range (greater than or equal to treeSize)
+     * @throws MerkleTreeEmptyException if treeSize is 0
+     * @throws MerkleTreeSizeOutOfRangeException if treeSize is greater than the current tree size
+     */
+    [[nodiscard]] proof_t generateProof(std::size_t leafNodeIndex, std::size_t treeSize) const;
+
+    /**
+     * Generate a single proof for many indexes at once, to be used in the `verifyMultiProof` function. Sibling hashes
+     * shared by several paths (or that are path nodes themselves) are left out, so the proof is much smaller than
+     * separate proofs of all the indexes whenever the indexes are close enough to share the upper part of their paths.
+     * The indexes can be given in any order and may repeat.
+     *
+     * @throws MerkleNodeIndexOutOfRangeException if any of the indexes is out of range
+     * @throws MerkleTreeEmptyException if the tree is empty
+     */
+    [[nodiscard]] multi_proof_t generateMultiProof(std::span<const std::size_t> leafNodeIndexes) const;
+
+    /**
+     * Generate a proof for the leaf nodes firstLeafNodeIndex, ..., endLeafNodeIndex - 1, to be used in the
+     * `verifyRangeProof` function. The proof has at most 2 * getTreeHeight() hashes no matter how long the range is.
+     *
+     * @throws MerkleNodeIndexOutOfRangeException unless firstLeafNodeIndex < endLeafNodeIndex <= getTreeSize()
+     * @throws MerkleTreeEmptyException if the tree is empty
+     */
+    [[nodiscard]] range_proof_t generateRangeProof(std::size_t firstLeafNodeIndex, std::size_t endLeafNodeIndex) const;
+
+    /**
+     * Generate a proof that the tree with the first `oldTreeSize` hashes is a prefix of the tree with the first
+     * `newTreeSize` hashes, to be used in the `verifyConsistency` function. Both sizes can be smaller than the current
+     * size, the hashes of the nodes that have changed since are recomputed from the stored complete subtrees, so
+     * generating a proof takes O(log n) time.
+     *
+     * @throws MerkleTreeSizeOutOfRangeException unless 0 < oldTreeSize <= newTreeSize <= getTreeSize()
+     */
+    [[nodiscard]] consistency_proof_t generateConsistencyProof(std::size_t oldTreeSize, std::size_t newTreeSize) const;
+
+    /**
+     * Write the tree to a tree file (see MerkleTreeFileHeader for the format), which can then be opened without
+     * rebuilding the tree with MappedMerkleTree. The stored tree is written as is, so any room left in it (see
+     * MerkleTreeOptions::initialHeight) is available for appending to the file.
+     *
+     * @throws MerkleTreeFileAccessException if the file cannot be written
+     */
+    void writeToFile(const std::string &path) const requires PersistentMerkleHasher<Hasher>;
 };
 
 
 /**
- * Verify whether the given data was in the tree with the given root hash.
+ * Verify whether the given data was in the tree with the given root hash. `Hasher` has to be the same hash function
+ * policy that the tree was created with.
  * @param rootHash the hash of the root node of the tree
  * @param proof the proof generated by `generateProof`
  * @param data the data whose presence in the tree is to be verified
  * @return true if the data was in the tree, false otherwise
  */
-[[nodiscard]] bool verifyProof(const hash_t &rootHash, const proof_t &proof, const std::string &data) noexcept;
+template<MerkleHasher Hasher = StdHasher>
+[[nodiscard]] bool verifyProof(const typename Hasher::digest_type &rootHash,
+                               const MerkleProof<typename Hasher::digest_type> &proof, std::string_view data) noexcept;
+
+
+/**
+ * Verify whether the tree with the root hash `oldRootHash` is a prefix of the tree with the root hash `newRootHash`,
+ * with the sizes given in the proof. `Hasher` has to be the same hash function policy that the tree was created with.
+ * @param oldRootHash the root hash of the tree when it had proof.oldTreeSize hashes
+ * @param newRootHash the root hash of the tree when it had proof.newTreeSize hashes
+ * @param proof the proof generated by `generateConsistencyProof`
+ * @return true if the newer tree was made by appending hashes to the older tree, false otherwise
+ */
+template<MerkleHasher Hasher = StdHasher>
+[[nodiscard]] bool verifyConsistency(const typename Hasher::digest_type &oldRootHash,
+                                     const typename Hasher::digest_type &newRootHash,
+                                     const MerkleConsistencyProof<typename Hasher::digest_type> &proof) noexcept;
+
+/**
+ * Verify whether the data was in the tree with the given root hash at all the indexes of a multiproof.
+ * `Hasher` has to be the same hash function policy that the tree was created with.
+ *
+ * The known nodes of every level are hashed into their parents with a single call to `hashNodePairs`, the same way as
+ * in `verifyProofs`.
+ *
+ * @param rootHash the root hash of the tree
+ * @param proof the proof generated by `generateMultiProof`
+ * @param data the data at each of the indexes, in the order of proof.leafNodeIndexes
+ * @return true if all the data was in the tree at the given indexes, false otherwise
+ * @throws MerkleProofCountMismatchException if there are not as many data values as there are indexes in the proof
+ */
+template<MerkleHasher Hasher = StdHasher>
+[[nodiscard]] bool verifyMultiProof(const typename Hasher::digest_type &rootHash,
+                                    const MerkleMultiProof<typename Hasher::digest_type> &proof,
+                                    std::span<const std::string> data);
+
+/**
+ * Verify whether the data was in the tree with the given root hash at the consecutive indexes of a range proof.
+ * `Hasher` has to be the same hash function policy that the tree was created with.
+ *
+ * The subtree of the range is rebuilt level by level, each level with a single call to `hashNodePairs`.
+ *
+ * @param rootHash the root hash of the tree
+ * @param proof the proof generated by `generateRangeProof`
+ * @param data the data at each index of the range, in order
+ * @return true if all the data was in the tree at the given indexes, false otherwise
+ * @throws MerkleProofCountMismatchException if there are not as many data values as there are leaves in the range
+ */
+template<MerkleHasher Hasher = StdHasher>
+[[nodiscard]] bool verifyRangeProof(const typename Hasher::digest_type &rootHash,
+                                    const MerkleRangeProof<typename Hasher::digest_type> &proof,
+                                    std::span<const std::string> data);
+
+/**
+ * Verify many proofs against the same root hash at once: the result has a bit for every proof, which is the same as
+ * `verifyProof<Hasher>(rootHash, proofs[i], data[i])` would return.
+ *
+ * The proofs are verified in batches of `proofBatchSize`, one level at a time: the node pairs of all the proofs in a
+ * batch that have not ended yet are hashed with a single call to `hashNodePairs`, so with Sha256Hasher they are spread
+ * over the lanes of the SIMD kernels. A proof drops out of its batch as soon as it runs out of sibling hashes, so
+ * shorter proofs do not cost any hashing on the levels above them.
+ *
+ * @throws MerkleProofCountMismatchException if there are not as many data values as there are proofs
+ */
+template<MerkleHasher Hasher = StdHasher>
+[[nodiscard]] std::vector<bool> verifyProofs(const typename Hasher::digest_type &rootHash,
+                                             std::span<const MerkleProof<typename Hasher::digest_type>> proofs,
+                                             std::span<const std::string> data);
+
+/**
+ * Number of proofs that `verifyProofs` verifies side by side. Large enough to fill the lanes of every SHA-256 kernel
+ * many times over, small enough for the hashes of a batch to stay in the L1 cache.
+ */
+static constexpr std::size_t proofBatchSize = 256;
+
+
+#include "merkle_tree.tpp"
+
@@ -0,0 +1,1044 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include "merkle_tree_exceptions.hpp"
+
+
+template<MerkleHasher Hasher>
+typename MerkleTree<Hasher>::MerkleNode MerkleTree<Hasher>::MerkleNode::getSiblingNode() const noexcept {
+    /**
+     * The sibling node that we're looking for is on the same level as this node (as it has the same parent).
+     *
+     * Two siblings have indexes 0 and 1, 2 and 3, 4 and 5, etc. If this node has the even index out of the two,
+     * then its sibling must have the odd index which is greater by 1. This means 0 -> 1, 2 -> 3, 4 -> 5, etc.
+     *
+     * If this node has the odd index out of the two, then its sibling must have the even index which is smaller by 1.
+     * This means 1 -> 0, 3 -> 2, 5 -> 4, etc.
+     */
+
+    if (index % 2 == 0) {
+        return {level, index + 1};
+    }
+
+    return {level, index - 1};
+}
+
+template<MerkleHasher Hasher>
+MerkleTree<Hasher>::MerkleTree(const MerkleTreeOptions &options)
+    : maxHeight(options.maxHeight), threadCount(options.threadCount), lazyRootUpdates(options.lazyRootUpdates) {
+    if (options.maxHeight > maxTreeHeight || options.initialHeight > options.maxHeight) {
+        throw MerkleTreeHeightOutOfRangeException();
+    }
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * All the nodes of a new tree are empty, so none of them has a hash yet (see `nodeHashes`).
+     */
+    storageHeight = options.initialHeight;
+    nodeHashes.resize(std::size_t{2} << storageHeight);
+
+    if (lazyRootUpdates) {
+        dirtyNodes.resize(storageHeight + 1);
+        for (std::size_t level = 1; level <= storageHeight; level++) {
+            dirtyNodes[level].resize(((std::size_t{1} << (storageHeight - level)) + 63) / 64);
+        }
+    }
+}
+
+template<MerkleHasher Hasher>
+std::size_t MerkleTree<Hasher>::getHeightForSize(const std::size_t treeSize) noexcept {
+    /**
+     * The smallest h for which 2^h >= treeSize is the number of bits needed to represent treeSize - 1 (the index of
+     * the last leaf node), e.g. 5 leaves have indexes 0..4 and 4 = 100 in binary needs 3 bits, so the height is 3.
+     */
+    if (treeSize <= 1) {
+        return 0;
+    }
+
+    return static_cast<std::size_t>(std::bit_width(treeSize - 1));
+}
+
+template<MerkleHasher Hasher>
+typename MerkleTree<Hasher>::hash_t MerkleTree<Hasher>::getNodeHash(const MerkleNode &node) const noexcept {
+    return nodeHashes[getNodePosition(node)];
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::updatePathToRoot(const MerkleNode &leafNode) noexcept {
+    /**
+     * Go up the tree one level at a time, from the leaf node to the topmost node. Since the children of a node are always
+     * updated before the node itself, the stored hashes of the children are up to date when the parent is rehashed.
+     */
+    MerkleNode parentNode = leafNode;
+
+    while (parentNode.level < storageHeight) {
+        parentNode = parentNode.getParentNode();
+        rehashNode(parentNode);
+    }
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::rehashNode(const MerkleNode &node) const noexcept {
+    const hash_t leftChildHash = getNodeHash(node.getLeftChild());
+
+    if (hasEmptyRightChild(node, currentTreeSize)) {
+        nodeHashes[getNodePosition(node)] = leftChildHash;
+    } else {
+        nodeHashes[getNodePosition(node)] = Hasher::hashNode(leftChildHash, getNodeHash(node.getRightChild()));
+    }
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::rehashNodes(const std::size_t level, std::span<const std::size_t> nodeIndexes) const {
+    /**
+     * Only the last node of a level can be without a right child, and since the indexes are sorted, it can only be the
+     * last one given.
+     */
+    if (!nodeIndexes.empty() && hasEmptyRightChild({level, nodeIndexes.back()}, currentTreeSize)) {
+        rehashNode({level, nodeIndexes.back()});
+        nodeIndexes = nodeIndexes.first(nodeIndexes.size() - 1);
+    }
+
+    const std::span<const hash_t> childNodes = getLevelHashes(level - 1);
+    std::vector<hash_t> childHashes(2 * nodeIndexes.size());
+    std::vector<hash_t> parentHashes(nodeIndexes.size());
+
+    for (std::size_t i = 0; i < nodeIndexes.size(); i++) {
+        childHashes[2 * i] = childNodes[2 * nodeIndexes[i]];
+        childHashes[2 * i + 1] = childNodes[2 * nodeIndexes[i] + 1];
+    }
+
+    hashNodePairs<Hasher>(childHashes, parentHashes);
+
+    const std::span<hash_t> parentNodes = getLevelHashes(level);
+    for (std::size_t i = 0; i < nodeIndexes.size(); i++) {
+        parentNodes[nodeIndexes[i]] = parentHashes[i];
+    }
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::markPathDirty(const MerkleNode &leafNode) noexcept {
+    MerkleNode parentNode = leafNode;
+
+    while (parentNode.level < storageHeight) {
+        parentNode = parentNode.getParentNode();
+
+        std::uint64_t &dirtyWord = dirtyNodes[parentNode.level][parentNode.index / 64];
+        const std::uint64_t dirtyBit = std::uint64_t{1} << (parentNode.index % 64);
+
+        if ((dirtyWord & dirtyBit) != 0) {
+            break;
+        }
+        dirtyWord |= dirtyBit;
+    }
+
+    hasDirtyNodes = true;
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::rehashDirtyNodes() const {
+    if (!hasDirtyNodes) {
+        return;
+    }
+
+    /**
+     * A dirty node only becomes up to date once all of its dirty descendants are, so the levels are processed from the
+     * bottom up. The set bits of a level's bitmap are collected in order (skipping whole clean words at a time) and
+     * cleared, and the collected nodes are rehashed together.
+     */
+    std::vector<std::size_t> dirtyIndexes;
+
+    for (std::size_t level = 1; level <= storageHeight; level++) {
+        std::vector<std::uint64_t> &levelBitmap = dirtyNodes[level];
+        dirtyIndexes.clear();
+
+        for (std::size_t word = 0; word < levelBitmap.size(); word++) {
+            for (std::uint64_t bits = levelBitmap[word]; bits != 0; bits &= bits - 1) {
+                dirtyIndexes.push_back(64 * word + static_cast<std::size_t>(std::countr_zero(bits)));
+            }
+            levelBitmap[word] = 0;
+        }
+
+        rehashNodes(level, dirtyIndexes);
+    }
+
+    hasDirtyNodes = false;
+    currentRootHash = getNodeHash({getTreeHeight(), 0});
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::updateLevels(const std::size_t level, const std::size_t firstIndex, const std::size_t lastIndex,
+                              const std::size_t topLevel) noexcept {
+    /**
+     * Same as `updatePathToRoot`, but for a range of nodes at a time: the parents of the nodes [first, last) on one
+     * level are the nodes [first / 2, (last - 1) / 2] on the level above. Only the last of them can be without a right
+     * child, all the others are hashed in bulk.
+     */
+    std::size_t firstParentIndex = firstIndex;
+    std::size_t lastParentIndex = lastIndex;
+
+    for (std::size_t parentLevel = level + 1; parentLevel <= topLevel; parentLevel++) {
+        firstParentIndex /= 2;
+        lastParentIndex = (lastParentIndex - 1) / 2 + 1;
+
+        const std::span<const hash_t> childNodes = getLevelHashes(parentLevel - 1);
+        const std::span<hash_t> parentNodes = getLevelHashes(parentLevel);
+        std::size_t parentCount = lastParentIndex - firstParentIndex;
+
+        if (hasEmptyRightChild({parentLevel, lastParentIndex - 1}, currentTreeSize)) {
+            parentNodes[lastParentIndex - 1] = childNodes[2 * (lastParentIndex - 1)];
+            parentCount--;
+        }
+
+        hashNodePairs<Hasher>(childNodes.subspan(2 * firstParentIndex, 2 * parentCount),
+                              parentNodes.subspan(firstParentIndex, parentCount));
+    }
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::buildFromLeaves(const std::size_t firstLeafIndex, const std::size_t lastLeafIndex,
+                                 const std::function<void(std::size_t, std::size_t)> &hashLeafNodes) {
+    const std::size_t topLevel = storageHeight;
+    const std::size_t leafCount = lastLeafIndex - firstLeafIndex;
+    const std::size_t usedThreadCount = std::min(threadCount, leafCount / minLeavesPerThread);
+
+    if (usedThreadCount <= 1) {
+        hashLeafNodes(firstLeafIndex, lastLeafIndex);
+        updateLevels(0, firstLeafIndex, lastLeafIndex, topLevel);
+        return;
+    }
+
+    /**
+     * The chunks are subtrees of height chunkLevel, i.e. the chunk boundaries are multiples of 2^chunkLevel. A node on
+     * a level up to chunkLevel never has leaves from two different chunks, so the threads never write the same node.
+     * (The first and the last node of the range may have leaves outside of it, but those are only read.)
+     *
+     * There are a few chunks per thread so that the threads can balance out their work by taking the next free chunk.
+     */
+    const std::size_t chunkLevel = std::min<std::size_t>(std::bit_width(leafCount / (4 * usedThreadCount)) - 1, topLevel);
+    const std::size_t firstChunk = firstLeafIndex >> chunkLevel;
+    const std::size_t lastChunk = ((lastLeafIndex - 1) >> chunkLevel) + 1;
+    std::atomic<std::size_t> nextChunk = firstChunk;
+
+    /**
+     * An exception in one of the threads stops the others from taking more chunks and is rethrown on the calling thread
+     * once all of them are done. The threads are joined when `threads` goes out of scope, even if starting one of them
+     * throws.
+     */
+    std::exception_ptr firstException;
+    std::mutex firstExceptionMutex;
+
+    const auto buildChunks = [&]() {
+        try {
+            for (std::size_t chunk = nextChunk++; chunk < lastChunk; chunk = nextChunk++) {
+                const std::size_t chunkFirst = std::max(chunk << chunkLevel, firstLeafIndex);
+                const std::size_t chunkLast = std::min((chunk + 1) << chunkLevel, lastLeafIndex);
+
+                hashLeafNodes(chunkFirst, chunkLast);
+                updateLevels(0, chunkFirst, chunkLast, chunkLevel);
+            }
+        } catch (...) {
+            nextChunk = lastChunk;
+            const std::lock_guard lock(firstExceptionMutex);
+            if (!firstException) {
+                firstException = std::current_exception();
+            }
+        }
+    };
+
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(usedThreadCount - 1);
+        for (std::size_t i = 1; i < usedThreadCount; i++) {
+            threads.emplace_back(buildChunks);
+        }
+
+        buildChunks();
+    }
+
+    if (firstException) {
+        std::rethrow_exception(firstException);
+    }
+
+    updateLevels(chunkLevel, firstChunk, lastChunk, topLevel);
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::grow() {
+    if (storageHeight == maxHeight) {
+        throw MerkleTreeFullException();
+    }
+
+    rehashDirtyNodes();
+
+    /**
+     * The current tree becomes the left subtree of the new root node and an empty tree of the same height becomes the
+     * right subtree. None of the stored hashes change, but every level moves to twice its old position in the heap order
+     * (the second half of each level stays empty), so the levels are copied into a new buffer. The new root node has no
+     * leaves on its right, so it takes the hash of the current topmost node without any hashing.
+     */
+    std::vector<hash_t> oldNodeHashes(std::size_t{4} << storageHeight);
+    oldNodeHashes.swap(nodeHashes);
+    storageHeight++;
+
+    for (std::size_t level = 0; level < storageHeight; level++) {
+        const std::size_t oldLevelSize = std::size_t{1} << (storageHeight - 1 - level);
+        const auto oldLevelBegin = oldNodeHashes.begin() + static_cast<std::ptrdiff_t>(oldLevelSize);
+
+        std::copy(oldLevelBegin, oldLevelBegin + static_cast<std::ptrdiff_t>(oldLevelSize), getLevelHashes(level).begin());
+    }
+
+    nodeHashes[1] = oldNodeHashes[1];
+
+    if (lazyRootUpdates) {
+        dirtyNodes.emplace_back();
+        for (std::size_t level = 1; level <= storageHeight; level++) {
+            dirtyNodes[level].assign(((std::size_t{1} << (storageHeight - level)) + 63) / 64, 0);
+        }
+    }
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::reserveCapacity(const std::size_t treeSize) {
+    if (getHeightForSize(treeSize) > maxHeight) {
+        throw MerkleTreeFullException();
+    }
+
+    while ((std::size_t{1} << storageHeight) < treeSize) {
+        grow();
+    }
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::addHashOf(const std::string_view data) {
+    if (isFull()) {
+        grow();
+    }
+
+    const hash_t dataHash = Hasher::hashLeaf(data);
+    const MerkleNode leafNode = {0, currentTreeSize};
+    nodeHashes[getNodePosition(leafNode)] = dataHash;
+    currentTreeSize++;
+
+    if (lazyRootUpdates) {
+        markPathDirty(leafNode);
+        return;
+    }
+
+    updatePathToRoot(leafNode);
+
+    currentRootHash = getNodeHash({getTreeHeight(), 0});
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::addHashesOf(const std::span<const std::string> data) {
+    addHashesOf(data.begin(), data.end());
+}
+
+template<MerkleHasher Hasher>
+template<std::forward_iterator Iterator>
+void MerkleTree<Hasher>::addHashesOf(Iterator first, Iterator last) {
+    /**
+     * Each thread jumps to the start of the chunks it takes (see `buildFromLeaves`), which takes linear time with
+     * anything but random access iterators, so other iterators are first turned into views that can be indexed.
+     */
+    if constexpr (!std::random_access_iterator<Iterator>) {
+        if (threadCount > 1) {
+            const std::vector<std::string_view> dataViews(first, last);
+            addHashesOf(dataViews.begin(), dataViews.end());
+            return;
+        }
+    }
+
+    const auto dataCount = static_cast<std::size_t>(std::distance(first, last));
+    if (dataCount == 0) {
+        return;
+    }
+
+    reserveCapacity(currentTreeSize + dataCount);
+
+    const std::span<hash_t> leafNodes = getLevelHashes(0);
+    const std::size_t firstLeafIndex = currentTreeSize;
+    currentTreeSize = firstLeafIndex + dataCount;
+
+    const auto hashLeafNodes = [&](const std::size_t chunkFirst, const std::size_t chunkLast) {
+        Iterator chunkData = std::next(first, static_cast<std::iter_difference_t<Iterator>>(chunkFirst - firstLeafIndex));
+
+        for (std::size_t leafNodeIndex = chunkFirst; leafNodeIndex < chunkLast; leafNodeIndex++, ++chunkData) {
+            leafNodes[leafNodeIndex] = Hasher::hashLeaf(std::string_view(*chunkData));
+        }
+    };
+
+    /**
+     * In lazy mode, the ancestors are only marked dirty, like in `addHashOf`. Consecutive leaves share most of their
+     * ancestors and marking stops at the first dirty one, so this takes about two steps per leaf.
+     */
+    if (lazyRootUpdates) {
+        hashLeafNodes(firstLeafIndex, currentTreeSize);
+        for (std::size_t leafNodeIndex = firstLeafIndex; leafNodeIndex < currentTreeSize; leafNodeIndex++) {
+            markPathDirty({0, leafNodeIndex});
+        }
+        return;
+    }
+
+    buildFromLeaves(firstLeafIndex, currentTreeSize, hashLeafNodes);
+
+    currentRootHash = getNodeHash({getTreeHeight(), 0});
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::updateLeaf(const std::size_t leafNodeIndex, const std::string_view data) {
+    if (leafNodeIndex >= currentTreeSize) {
+        throw MerkleNodeIndexOutOfRangeException();
+    }
+
+    nodeHashes[getNodePosition({0, leafNodeIndex})] = Hasher::hashLeaf(data);
+
+    if (lazyRootUpdates) {
+        markPathDirty({0, leafNodeIndex});
+        return;
+    }
+
+    updatePathToRoot({0, leafNodeIndex});
+
+    currentRootHash = getNodeHash({getTreeHeight(), 0});
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::updateLeaves(const std::span<const std::pair<std::size_t, std::string>> updates) {
+    for (const auto &[leafNodeIndex, data] : updates) {
+        if (leafNodeIndex >= currentTreeSize) {
+            throw MerkleNodeIndexOutOfRangeException();
+        }
+    }
+
+    if (updates.empty()) {
+        return;
+    }
+
+    std::vector<std::size_t> dirtyIndexes;
+    dirtyIndexes.reserve(updates.size());
+
+    for (const auto &[leafNodeIndex, data] : updates) {
+        nodeHashes[getNodePosition({0, leafNodeIndex})] = Hasher::hashLeaf(data);
+        dirtyIndexes.push_back(leafNodeIndex);
+    }
+
+    if (lazyRootUpdates) {
+        for (const std::size_t leafNodeIndex : dirtyIndexes) {
+            markPathDirty({0, leafNodeIndex});
+        }
+        return;
+    }
+
+    std::sort(dirtyIndexes.begin(), dirtyIndexes.end());
+    dirtyIndexes.erase(std::unique(dirtyIndexes.begin(), dirtyIndexes.end()), dirtyIndexes.end());
+
+    /**
+     * Go up the tree one level at a time, like `updatePathToRoot` does for a single leaf. The dirty nodes on each level
+     * are the parents of the dirty nodes on the level below; since the indexes are sorted, siblings are next to each
+     * other and map to the same parent, so removing consecutive duplicates leaves every dirty parent exactly once.
+     */
+    for (std::size_t level = 1; level <= storageHeight; level++) {
+        for (std::size_t &dirtyIndex : dirtyIndexes) {
+            dirtyIndex /= 2;
+        }
+        dirtyIndexes.erase(std::unique(dirtyIndexes.begin(), dirtyIndexes.end()), dirtyIndexes.end());
+
+        rehashNodes(level, dirtyIndexes);
+    }
+
+    currentRootHash = getNodeHash({getTreeHeight(), 0});
+}
+
+template<MerkleHasher Hasher>
+typename MerkleTree<Hasher>::hash_t MerkleTree<Hasher>::getRootHash() const {
+    if (isEmpty()) {
+        throw MerkleTreeEmptyException();
+    }
+
+    rehashDirtyNodes();
+    return currentRootHash;
+}
+
+template<MerkleHasher Hasher>
+typename MerkleTree<Hasher>::proof_t MerkleTree<Hasher>::generateProof(const std::size_t leafNodeIndex) const {
+    if (isEmpty()) {
+        throw MerkleTreeEmptyException();
+    }
+
+    if (leafNodeIndex >= currentTreeSize) {
+        throw MerkleNodeIndexOutOfRangeException();
+    }
+
+    rehashDirtyNodes();
+    const std::size_t treeHeight = getTreeHeight();
+
+    /**
+     * Go up the tree from the leaf node to the root node (in order to find the index of the parent node one level above,
+     * floor divide the current index by 2, so 0 and 1 map to 0, 2 and 3 map to 1, etc.). For each node on the path,
+     * find the hash of its sibling -- these hashes together constitute the proof. See the implementation of
+     * `verifyProof` for details on how the proof is used.
+     */
+    proof_t proof;
+    proof.leafNodeIndex = leafNodeIndex;
+    proof.treeSize = currentTreeSize;
+    proof.siblingHashes.reserve(treeHeight);
+
+    for (MerkleNode pathNode = {0, leafNodeIndex}; pathNode.level < treeHeight; pathNode = pathNode.getParentNode()) {
+        const MerkleNode siblingNode = pathNode.getSiblingNode();
+
+        if (siblingNode.index << siblingNode.level < currentTreeSize) {
+            proof.siblingHashes.push_back(getNodeHash(siblingNode));
+        }
+    }
+
+    return proof;
+}
+
+template<MerkleHasher Hasher>
+typename MerkleTree<Hasher>::HistoricalHashes MerkleTree<Hasher>::getHistoricalHashes(const std::size_t treeSize) const {
+    rehashDirtyNodes();
+
+    const std::size_t treeHeight = getHeightForSize(treeSize);
+    HistoricalHashes historicalHashes = {treeSize, std::vector<hash_t>(treeHeight + 1)};
+
+    /**
+     * The incomplete nodes are the ancestors of the last leaf whose subtrees extend past it. Going up from the leaves,
+     * the children of each of them are complete (stored) or the incomplete node one level below, and a right child
+     * without leaves means that the node takes the hash of its left child.
+     */
+    for (MerkleNode node = {1, (treeSize - 1) / 2}; node.level <= treeHeight; node = node.getParentNode()) {
+        const hash_t leftChildHash = getHistoricalNodeHash(node.getLeftChild(), historicalHashes);
+
+        if (hasEmptyRightChild(node, treeSize)) {
+            historicalHashes.incompleteNodeHashes[node.level] = leftChildHash;
+        } else {
+            historicalHashes.incompleteNodeHashes[node.level] =
+                    Hasher::hashNode(leftChildHash, getHistoricalNodeHash(node.getRightChild(), historicalHashes));
+        }
+    }
+
+    return historicalHashes;
+}
+
+template<MerkleHasher Hasher>
+typename MerkleTree<Hasher>::hash_t MerkleTree<Hasher>::getHistoricalNodeHash(
+        const MerkleNode &node, const HistoricalHashes &historicalHashes) const noexcept {
+    const std::size_t firstLeafIndex = node.index << node.level;
+    const std::size_t leafCount = std::size_t{1} << node.level;
+
+    if (firstLeafIndex + leafCount <= historicalHashes.treeSize) {
+        return getNodeHash(node);
+    }
+
+    return historicalHashes.incompleteNodeHashes[node.level];
+}
+
+template<MerkleHasher Hasher>
+typename MerkleTree<Hasher>::hash_t MerkleTree<Hasher>::getRootHash(const std::size_t treeSize) const {
+    if (treeSize == 0) {
+        throw MerkleTreeEmptyException();
+    }
+
+    if (treeSize > currentTreeSize) {
+        throw MerkleTreeSizeOutOfRangeException();
+    }
+
+    const HistoricalHashes historicalHashes = getHistoricalHashes(treeSize);
+    return getHistoricalNodeHash({getHeightForSize(treeSize), 0}, historicalHashes);
+}
+
+template<MerkleHasher Hasher>
+typename MerkleTree<Hasher>::proof_t MerkleTree<Hasher>::generateProof(const std::size_t leafNodeIndex,
+                                                                       const std::size_t treeSize) const {
+    if (treeSize == 0) {
+        throw MerkleTreeEmptyException();
+    }
+
+    if (treeSize > currentTreeSize) {
+        throw MerkleTreeSizeOutOfRangeException();
+    }
+
+    if (leafNodeIndex >= treeSize) {
+        throw MerkleNodeIndexOutOfRangeException();
+    }
+
+    const HistoricalHashes historicalHashes = getHistoricalHashes(treeSize);
+    const std::size_t treeHeight = getHeightForSize(treeSize);
+
+    proof_t proof;
+    proof.leafNodeIndex = leafNodeIndex;
+    proof.treeSize = treeSize;
+    proof.siblingHashes.reserve(treeHeight);
+
+    for (MerkleNode pathNode = {0, leafNodeIndex}; pathNode.level < treeHeight; pathNode = pathNode.getParentNode()) {
+        const MerkleNode siblingNode = pathNode.getSiblingNode();
+
+        if (siblingNode.index << siblingNode.level < treeSize) {
+            proof.siblingHashes.push_back(getHistoricalNodeHash(siblingNode, historicalHashes));
+        }
+    }
+
+    return proof;
+}
+
+template<MerkleHasher Hasher>
+typename MerkleTree<Hasher>::multi_proof_t MerkleTree<Hasher>::generateMultiProof(
+        const std::span<const std::size_t> leafNodeIndexes) const {
+    if (isEmpty()) {
+        throw MerkleTreeEmptyException();
+    }
+
+    for (const std::size_t leafNodeIndex : leafNodeIndexes) {
+        if (leafNodeIndex >= currentTreeSize) {
+            throw MerkleNodeIndexOutOfRangeException();
+        }
+    }
+
+    rehashDirtyNodes();
+    const std::size_t treeHeight = getTreeHeight();
+
+    multi_proof_t proof;
+    proof.treeSize = currentTreeSize;
+    proof.leafNodeIndexes.assign(leafNodeIndexes.begin(), leafNodeIndexes.end());
+    std::sort(proof.leafNodeIndexes.begin(), proof.leafNodeIndexes.end());
+    proof.leafNodeIndexes.erase(std::unique(proof.leafNodeIndexes.begin(), proof.leafNodeIndexes.end()),
+                                proof.leafNodeIndexes.end());
+
+    /**
+     * Go up the tree one level at a time, keeping the sorted indexes of the path nodes on the current level. A path
+     * node whose sibling is a path node too (the next index in the list) needs no sibling hash and neither does the
+     * last node of a level if it has no sibling, otherwise the sibling hash goes into the proof. The parents of the path
+     * nodes are the path nodes of the level above.
+     */
+    std::vector<std::size_t> pathNodeIndexes = proof.leafNodeIndexes;
+
+    for (std::size_t level = 0; level < treeHeight; level++) {
+        const std::size_t lastLevelIndex = (currentTreeSize - 1) >> level;
+        std::size_t parentCount = 0;
+
+        for (std::size_t i = 0; i < pathNodeIndexes.size(); i++) {
+            const std::size_t index = pathNodeIndexes[i];
+
+            if (index % 2 == 0 && i + 1 < pathNodeIndexes.size() && pathNodeIndexes[i + 1] == index + 1) {
+                i++;
+            } else if (index % 2 == 1 || index < lastLevelIndex) {
+                proof.siblingHashes.push_back(getNodeHash(MerkleNode(level, index).getSiblingNode()));
+            }
+
+            pathNodeIndexes[parentCount++] = index / 2;
+        }
+
+        pathNodeIndexes.resize(parentCount);
+    }
+
+    return proof;
+}
+
+template<MerkleHasher Hasher>
+typename MerkleTree<Hasher>::range_proof_t MerkleTree<Hasher>::generateRangeProof(
+        const std::size_t firstLeafNodeIndex, const std::size_t endLeafNodeIndex) const {
+    if (isEmpty()) {
+        throw MerkleTreeEmptyException();
+    }
+
+    if (firstLeafNodeIndex >= endLeafNodeIndex || endLeafNodeIndex > currentTreeSize) {
+        throw MerkleNodeIndexOutOfRangeException();
+    }
+
+    rehashDirtyNodes();
+    const std::size_t treeHeight = getTreeHeight();
+
+    range_proof_t proof;
+    proof.treeSize = currentTreeSize;
+    proof.firstLeafNodeIndex = firstLeafNodeIndex;
+    proof.leafCount = endLeafNodeIndex - firstLeafNodeIndex;
+
+    /**
+     * On every level, the nodes spanned by the range are firstIndex, ..., lastIndex. Their parents can all be computed
+     * from them, except that the first one may need its left sibling and the last one its right sibling (if it is not
+     * the last node of the level).
+     */
+    std::size_t firstIndex = firstLeafNodeIndex;
+    std::size_t lastIndex = endLeafNodeIndex - 1;
+
+    for (std::size_t level = 0; level < treeHeight; level++) {
+        if (firstIndex % 2 == 1) {
+            proof.leftSiblingHashes.push_back(getNodeHash({level, firstIndex - 1}));
+        }
+
+        if (lastIndex % 2 == 0 && lastIndex < (currentTreeSize - 1) >> level) {
+            proof.rightSiblingHashes.push_back(getNodeHash({level, lastIndex + 1}));
+        }
+
+        firstIndex /= 2;
+        lastIndex /= 2;
+    }
+
+    return proof;
+}
+
+template<MerkleHasher Hasher>
+typename MerkleTree<Hasher>::consistency_proof_t MerkleTree<Hasher>::generateConsistencyProof(
+        const std::size_t oldTreeSize, const std::size_t newTreeSize) const {
+    if (oldTreeSize == 0 || oldTreeSize > newTreeSize || newTreeSize > currentTreeSize) {
+        throw MerkleTreeSizeOutOfRangeException();
+    }
+
+    /**
+     * The path of the last leaf of the older tree in the newer tree is exactly the historical proof of that leaf.
+     */
+    proof_t leafProof = generateProof(oldTreeSize - 1, newTreeSize);
+
+    consistency_proof_t proof;
+    proof.oldTreeSize = oldTreeSize;
+    proof.newTreeSize = newTreeSize;
+    proof.lastOldLeafHash = getNodeHash({0, oldTreeSize - 1});
+    proof.siblingHashes = std::move(leafProof.siblingHashes);
+
+    return proof;
+}
+
+template<MerkleHasher Hasher>
+void MerkleTree<Hasher>::writeToFile(const std::string &path) const requires PersistentMerkleHasher<Hasher> {
+    rehashDirtyNodes();
+
+    MerkleTreeFileHeader header;
+    header.hasherId = Hasher::hasherId;
+    header.digestSize = sizeof(hash_t);
+    header.storageHeight = storageHeight;
+    header.treeSize = currentTreeSize;
+
+    writeTreeFile(path, header, std::as_bytes(std::span(nodeHashes)));
+}
+
+template<MerkleHasher Hasher>
+bool verifyProof(const typename Hasher::digest_type &rootHash, const MerkleProof<typename Hasher::digest_type> &proof,
+                 const std::string_view data) noexcept {
+    /**
+     * The proof consists of the hashes of the sibling nodes on the path from the leaf node to the root node. In order
+     * to see if the data was in the tree with the given root hash, we need to calculate the hash of the root node
+     * based on the given data node and the given proof.
+     *
+     * The hash of the data node combined with the first hash of the proof (which is the hash of the data node's sibling)
+     * is the hash of their parent node. This parent node is then combined with the next proof hash (the hash of the
+     * sibling of the data node's parent) and so on, until we reach the root node and its hash.
+     *
+     * On each level, the lowest bit of the node's index tells whether the node is a left child (even index) or a right
+     * child (odd index) and thus whether its sibling's hash goes on the right or on the left when the two are combined.
+     * A left child that is the last node of its level has no sibling and its parent has the same hash as the child
+     * itself. The root node is reached when the last node of the level is the first one.
+     */
+    if (proof.leafNodeIndex >= proof.treeSize) {
+        return false;
+    }
+
+    typename Hasher::digest_type computedHash = Hasher::hashLeaf(data);
+    std::size_t pathNodeIndex = proof.leafNodeIndex;
+    std::size_t lastNodeIndex = proof.treeSize - 1;
+    std::size_t usedSiblingCount = 0;
+
+    for (; lastNodeIndex > 0; pathNodeIndex /= 2, lastNodeIndex /= 2) {
+        if (pathNodeIndex % 2 == 0 && pathNodeIndex == lastNodeIndex) {
+            continue;
+        }
+
+        if (usedSiblingCount == proof.siblingHashes.size()) {
+            return false;
+        }
+
+        const typename Hasher::digest_type &proofHash = proof.siblingHashes[usedSiblingCount++];
+
+        if (pathNodeIndex % 2 == 0) {
+            computedHash = Hasher::hashNode(computedHash, proofHash);
+        } else {
+            computedHash = Hasher::hashNode(proofHash, computedHash);
+        }
+    }
+
+    return usedSiblingCount == proof.siblingHashes.size() && computedHash == rootHash;
+}
+
+template<MerkleHasher Hasher>
+bool verifyConsistency(const typename Hasher::digest_type &oldRootHash, const typename Hasher::digest_type &newRootHash,
+                       const MerkleConsistencyProof<typename Hasher::digest_type> &proof) noexcept {
+    using digest_type = typename Hasher::digest_type;
+
+    if (proof.oldTreeSize == 0 || proof.oldTreeSize > proof.newTreeSize) {
+        return false;
+    }
+
+    /**
+     * Both root hashes are computed from the last leaf of the older tree up, the same way as in `verifyProof`. The
+     * siblings on the left of the path are shared by both trees. The siblings on the right are only used for the newer
+     * tree; in the older tree, the path node is always the last node of its level, so it has no right sibling. Once the
+     * path reaches the root of the older tree, only the newer tree goes on.
+     */
+    std::size_t pathNodeIndex = proof.oldTreeSize - 1;
+    std::size_t lastNodeIndex = proof.newTreeSize - 1;
+    std::size_t usedSiblingCount = 0;
+
+    digest_type oldHash = proof.lastOldLeafHash;
+    digest_type newHash = proof.lastOldLeafHash;
+
+    for (; lastNodeIndex > 0; pathNodeIndex /= 2, lastNodeIndex /= 2) {
+        if (pathNodeIndex % 2 == 0 && pathNodeIndex == lastNodeIndex) {
+            continue;
+        }
+
+        if (usedSiblingCount == proof.siblingHashes.size()) {
+            return false;
+        }
+
+        const digest_type &siblingHash = proof.siblingHashes[usedSiblingCount++];
+
+        if (pathNodeIndex % 2 == 1) {
+            oldHash = Hasher::hashNode(siblingHash, oldHash);
+            newHash = Hasher::hashNode(siblingHash, newHash);
+        } else {
+            newHash = Hasher::hashNode(newHash, siblingHash);
+        }
+    }
+
+    return usedSiblingCount == proof.siblingHashes.size() && oldHash == oldRootHash && newHash == newRootHash;
+}
+
+template<MerkleHasher Hasher>
+bool verifyMultiProof(const typename Hasher::digest_type &rootHash,
+                      const MerkleMultiProof<typename Hasher::digest_type> &proof,
+                      const std::span<const std::string> data) {
+    using digest_type = typename Hasher::digest_type;
+
+    if (proof.leafNodeIndexes.size() != data.size()) {
+        throw MerkleProofCountMismatchException();
+    }
+
+    if (proof.treeSize == 0 || proof.leafNodeIndexes.empty() ||
+        std::adjacent_find(proof.leafNodeIndexes.begin(), proof.leafNodeIndexes.end(), std::greater_equal<>()) !=
+                proof.leafNodeIndexes.end() ||
+        proof.leafNodeIndexes.back() >= proof.treeSize) {
+        return false;
+    }
+
+    /**
+     * The same walk as in `MerkleTree::generateMultiProof`, except that the hashes of the path nodes are computed: on
+     * every level, both children of each parent are gathered into `childHashes` (from the path nodes or the next
+     * sibling hash of the proof) and all the parents are hashed at once. A last node without a sibling can only be the
+     * last path node, so it ends up alone at the end of `childHashes` and is passed on to its parent as it is.
+     */
+    const auto treeHeight = static_cast<std::size_t>(std::bit_width(proof.treeSize - 1));
+    std::vector<std::size_t> pathNodeIndexes = proof.leafNodeIndexes;
+    std::vector<digest_type> pathNodeHashes(data.size());
+    std::vector<digest_type> childHashes;
+    std::size_t usedSiblingCount = 0;
+
+    for (std::size_t i = 0; i < data.size(); i++) {
+        pathNodeHashes[i] = Hasher::hashLeaf(data[i]);
+    }
+
+    for (std::size_t level = 0; level < treeHeight; level++) {
+        const std::size_t lastLevelIndex = (proof.treeSize - 1) >> level;
+        std::size_t parentCount = 0;
+        childHashes.clear();
+
+        for (std::size_t i = 0; i < pathNodeIndexes.size(); i++) {
+            const std::size_t index = pathNodeIndexes[i];
+
+            if (index % 2 == 0 && i + 1 < pathNodeIndexes.size() && pathNodeIndexes[i + 1] == index + 1) {
+                childHashes.push_back(pathNodeHashes[i]);
+                childHashes.push_back(pathNodeHashes[++i]);
+            } else if (index % 2 == 0 && index == lastLevelIndex) {
+                childHashes.push_back(pathNodeHashes[i]);
+            } else if (usedSiblingCount == proof.siblingHashes.size()) {
+                return false;
+            } else if (index % 2 == 0) {
+                childHashes.push_back(pathNodeHashes[i]);
+                childHashes.push_back(proof.siblingHashes[usedSiblingCount++]);
+            } else {
+                childHashes.push_back(proof.siblingHashes[usedSiblingCount++]);
+                childHashes.push_back(pathNodeHashes[i]);
+            }
+
+            pathNodeIndexes[parentCount++] = index / 2;
+        }
+
+        const std::size_t pairCount = childHashes.size() / 2;
+        pathNodeIndexes.resize(parentCount);
+        pathNodeHashes.resize(parentCount);
+        hashNodePairs<Hasher>(std::span<const digest_type>(childHashes).first(2 * pairCount),
+                              std::span(pathNodeHashes).first(pairCount));
+
+        if (pairCount < parentCount) {
+            pathNodeHashes.back() = childHashes.back();
+        }
+    }
+
+    return usedSiblingCount == proof.siblingHashes.size() && pathNodeHashes.front() == rootHash;
+}
+
+template<MerkleHasher Hasher>
+bool verifyRangeProof(const typename Hasher::digest_type &rootHash,
+                      const MerkleRangeProof<typename Hasher::digest_type> &proof,
+                      const std::span<const std::string> data) {
+    using digest_type = typename Hasher::digest_type;
+
+    if (proof.leafCount != data.size()) {
+        throw MerkleProofCountMismatchException();
+    }
+
+    if (proof.leafCount == 0 || proof.firstLeafNodeIndex >= proof.treeSize ||
+        proof.leafCount > proof.treeSize - proof.firstLeafNodeIndex) {
+        return false;
+    }
+
+    /**
+     * Rebuild the nodes spanned by the range level by level, the same way as in `MerkleTree::generateRangeProof`. If
+     * the last of them has no right sibling, it is left alone at the end of `childHashes` and passed on to its parent
+     * as it is.
+     */
+    const auto treeHeight = static_cast<std::size_t>(std::bit_width(proof.treeSize - 1));
+    std::size_t firstIndex = proof.firstLeafNodeIndex;
+    std::size_t lastIndex = proof.firstLeafNodeIndex + proof.leafCount - 1;
+    std::size_t usedLeftCount = 0;
+    std::size_t usedRightCount = 0;
+
+    std::vector<digest_type> rangeHashes(data.size());
+    std::vector<digest_type> childHashes;
+
+    for (std::size_t i = 0; i < data.size(); i++) {
+        rangeHashes[i] = Hasher::hashLeaf(data[i]);
+    }
+
+    for (std::size_t level = 0; level < treeHeight; level++) {
+        const bool needsLeftSibling = firstIndex % 2 == 1;
+        const bool needsRightSibling = lastIndex % 2 == 0 && lastIndex < (proof.treeSize - 1) >> level;
+
+        if ((needsLeftSibling && usedLeftCount == proof.leftSiblingHashes.size()) ||
+            (needsRightSibling && usedRightCount == proof.rightSiblingHashes.size())) {
+            return false;
+        }
+
+        childHashes.clear();
+        if (needsLeftSibling) {
+            childHashes.push_back(proof.leftSiblingHashes[usedLeftCount++]);
+        }
+        childHashes.insert(childHashes.end(), rangeHashes.begin(), rangeHashes.end());
+        if (needsRightSibling) {
+            childHashes.push_back(proof.rightSiblingHashes[usedRightCount++]);
+        }
+
+        const std::size_t pairCount = childHashes.size() / 2;
+        firstIndex /= 2;
+        lastIndex /= 2;
+        rangeHashes.resize(lastIndex - firstIndex + 1);
+        hashNodePairs<Hasher>(std::span<const digest_type>(childHashes).first(2 * pairCount),
+                              std::span(rangeHashes).first(pairCount));
+
+        if (pairCount < rangeHashes.size()) {
+            rangeHashes.back() = childHashes.back();
+        }
+    }
+
+    return usedLeftCount == proof.leftSiblingHashes.size() && usedRightCount == proof.rightSiblingHashes.size() &&
+           rangeHashes.front() == rootHash;
+}
+
+template<MerkleHasher Hasher>
+std::vector<bool> verifyProofs(const typename Hasher::digest_type &rootHash,
+                               const std::span<const MerkleProof<typename Hasher::digest_type>> proofs,
+                               const std::span<const std::string> data) {
+    using digest_type = typename Hasher::digest_type;
+
+    if (proofs.size() != data.size()) {
+        throw MerkleProofCountMismatchException();
+    }
+
+    std::vector<bool> results(proofs.size(), false);
+
+    /**
+     * Every proof of a batch is computed the same way as in `verifyProof`, but the proofs take turns: on each level,
+     * the pairs of the proofs that are still going are gathered into `childHashes`, hashed all at once into
+     * `parentHashes` and scattered back to the proofs listed in `hashedProofs`. `activeProofs` holds the indexes
+     * (within the batch) of the proofs that have not reached their root yet, in order, so a finished proof is simply
+     * left out when the array is compacted. A proof whose path node has no sibling on a level stays active without
+     * being hashed.
+     */
+    std::vector<digest_type> computedHashes(proofBatchSize);
+    std::vector<digest_type> childHashes(2 * proofBatchSize);
+    std::vector<digest_type> parentHashes(proofBatchSize);
+    std::vector<std::size_t> activeProofs(proofBatchSize);
+    std::vector<std::size_t> hashedProofs(proofBatchSize);
+    std::vector<std::size_t> pathNodeIndexes(proofBatchSize);
+    std::vector<std::size_t> lastNodeIndexes(proofBatchSize);
+    std::vector<std::size_t> usedSiblingCounts(proofBatchSize);
+
+    for (std::size_t firstProof = 0; firstProof < proofs.size(); firstProof += proofBatchSize) {
+        const std::size_t batchSize = std::min(proofBatchSize, proofs.size() - firstProof);
+        std::size_t activeCount = 0;
+
+        for (std::size_t i = 0; i < batchSize; i++) {
+            const MerkleProof<digest_type> &proof = proofs[firstProof + i];
+            if (proof.leafNodeIndex >= proof.treeSize) {
+                continue;
+            }
+
+            computedHashes[i] = Hasher::hashLeaf(data[firstProof + i]);
+            pathNodeIndexes[i] = proof.leafNodeIndex;
+            lastNodeIndexes[i] = proof.treeSize - 1;
+            usedSiblingCounts[i] = 0;
+            activeProofs[activeCount++] = i;
+        }
+
+        while (activeCount > 0) {
+            std::size_t stillActiveCount = 0;
+            std::size_t hashedCount = 0;
+
+            for (std::size_t active = 0; active < activeCount; active++) {
+                const std::size_t i = activeProofs[active];
+                const MerkleProof<digest_type> &proof = proofs[firstProof + i];
+
+                if (lastNodeIndexes[i] == 0) {
+                    results[firstProof + i] =
+                            usedSiblingCounts[i] == proof.siblingHashes.size() && computedHashes[i] == rootHash;
+                    continue;
+                }
+
+                const bool isLeftChild = pathNodeIndexes[i] % 2 == 0;
+                const bool hasSibling = !isLeftChild || pathNodeIndexes[i] < lastNodeIndexes[i];
+                pathNodeIndexes[i] /= 2;
+                lastNodeIndexes[i] /= 2;
+
+                if (hasSibling) {
+                    if (usedSiblingCounts[i] == proof.siblingHashes.size()) {
+                        continue;
+                    }
+
+                    const digest_type &siblingHash = proof.siblingHashes[usedSiblingCounts[i]++];
+                    childHashes[2 * hashedCount] = isLeftChild ? computedHashes[i] : siblingHash;
+                    childHashes[2 * hashedCount + 1] = isLeftChild ? siblingHash : computedHashes[i];
+                    hashedProofs[hashedCount++] = i;
+                }
+
+                activeProofs[stillActiveCount++] = i;
+            }
+
+            activeCount = stillActiveCount;
+            hashNodePairs<Hasher>(std::span<const digest_type>(childHashes).first(2 * hashedCount),
+                                  std::span(parentHashes).first(hashedCount));
+
+            for (std::size_t hashed = 0; hashed < hashedCount; hashed++) {
+                computedHashes[hashedProofs[hashed]] = parentHashes[hashed];
+            }
+        }
+    }
+
+    return results;
+}
@@ -0,0 +1,754 @@
+#include <filesystem>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "append_only_merkle_tree.hpp"
+#include "kary_merkle_tree.hpp"
+#include "mapped_merkle_tree.hpp"
+#include "merkle_patricia_trie.hpp"
+#include "merkle_stream_builder.hpp"
+#include "merkle_tree.hpp"
+#include "sorted_merkle_tree.hpp"
+#include "sparse_merkle_tree.hpp"
+
+
+/**
+ * Build a tree with 2^treeHeight hashes and a fixed, pseudo-random sequence of leaf indexes to generate proofs for.
+ * Random indexes keep the benchmark from only ever touching the same (cached) path of the tree.
+ */
+static MerkleTree<> buildTree(const std::size_t treeHeight, std::vector<std::size_t> &leafNodeIndexes) {
+    const std::size_t treeSize = std::size_t{1} << treeHeight;
+
+    MerkleTreeOptions options;
+    options.initialHeight = treeHeight;
+    MerkleTree tree(options);
+
+    for (std::size_t i = 0; i < treeSize; i++) {
+        tree.addHashOf("data " + std::to_string(i));
+    }
+
+    std::mt19937_64 generator(treeHeight);
+    std::uniform_int_distribution<std::size_t> distribution(0, treeSize - 1);
+
+    leafNodeIndexes.resize(1024);
+    for (std::size_t &leafNodeIndex : leafNodeIndexes) {
+        leafNodeIndex = distribution(generator);
+    }
+
+    return tree;
+}
+
+TEST_CASE("Proof generation latency as the tree grows", "[benchmark]") {
+    for (const std::size_t treeHeight : {10, 14, 18, 20}) {
+        std::vector<std::size_t> leafNodeIndexes;
+        const MerkleTree tree = buildTree(treeHeight, leafNodeIndexes);
+        std::size_t nextIndex = 0;
+
+        BENCHMARK("generateProof, 2^" + std::to_string(treeHeight) + " leaves") {
+            nextIndex = (nextIndex + 1) % leafNodeIndexes.size();
+            return tree.generateProof(leafNodeIndexes[nextIndex]);
+        };
+    }
+}
+
+/**
+ * The node layouts compared by the "Proof generation with different node layouts" benchmark. Each of them stores all
+ * the nodes of a tree of height `treeHeight` in one flat buffer and maps the node (level, index) to its position in it,
+ * with levels counted from the bottom like in MerkleTree.
+ */
+struct NodeLayout {
+    const char *name;
+    std::size_t (*getBufferSize)(std::size_t treeHeight);
+    std::size_t (*getPosition)(std::size_t treeHeight, std::size_t level, std::size_t index);
+};
+
+/**
+ * Number of levels per block of the blocked layout: a block holds the 2 + 4 = 6 descendants of a node on the two
+ * levels below it, which together with 2 unused slots fill one 64-byte cache line of 8-byte hashes. A node and its
+ * sibling are always in the same block, so a proof touches one cache line per two levels.
+ */
+static constexpr std::size_t blockLevels = 2;
+static constexpr std::size_t blockSlots = 8;
+
+static std::size_t getBlockedLayoutBufferSize(const std::size_t treeHeight) {
+    /**
+     * The blocks hang off the nodes at depths 0, 2, 4, ... (counted from the root), depth 2j has 4^j of them, plus one
+     * slot-sized block at the start for the root node.
+     */
+    std::size_t blockCount = 1;
+    for (std::size_t depth = 0; depth < treeHeight; depth += blockLevels) {
+        blockCount += std::size_t{1} << depth;
+    }
+
+    return blockSlots * blockCount;
+}
+
+static const NodeLayout nodeLayouts[] = {
+    {
+        "level order (leaves first)",
+        [](const std::size_t treeHeight) { return std::size_t{2} << treeHeight; },
+        [](const std::size_t treeHeight, const std::size_t level, const std::size_t index) {
+            /**
+             * Level l starts after the 2^h + 2^(h-1) + ... + 2^(h-l+1) nodes of the levels below it.
+             */
+            return (std::size_t{2} << treeHeight) - (std::size_t{2} << (treeHeight - level)) + index;
+        },
+    },
+    {
+        "heap order (root first)",
+        [](const std::size_t treeHeight) { return std::size_t{2} << treeHeight; },
+        [](const std::size_t treeHeight, const std::size_t level, const std::size_t index) {
+            return (std::size_t{1} << (treeHeight - level)) + index;
+        },
+    },
+    {
+        "blocked (two levels per cache line)",
+        getBlockedLayoutBufferSize,
+        [](const std::size_t treeHeight, const std::size_t level, const std::size_t index) {
+            const std::size_t depth = treeHeight - level;
+            if (depth == 0) {
+                return std::size_t{0};
+            }
+
+            /**
+             * The node is `relativeDepth` levels below the node its block hangs off of. The blocks are numbered in
+             * breadth-first order of those nodes, so the blocks hanging off of shallower depths come first.
+             */
+            const std::size_t anchorDepth = (depth - 1) / blockLevels * blockLevels;
+            const std::size_t relativeDepth = depth - anchorDepth;
+            const std::size_t anchorIndex = index >> relativeDepth;
+            const std::size_t relativeIndex = index & ((std::size_t{1} << relativeDepth) - 1);
+            const std::size_t firstBlock = ((std::size_t{1} << anchorDepth) - 1) / ((std::size_t{1} << blockLevels) - 1);
+
+            return blockSlots * (1 + firstBlock + anchorIndex) + (std::size_t{1} << relativeDepth) - 2 + relativeIndex;
+        },
+    },
+};
+
+TEST_CASE("Proofs in partially filled trees", "[benchmark]") {
+    /**
+     * Trees just past a power of two: most leaves are in the complete left half, the few in the right part have much
+     * shorter proofs since the siblings without leaves are left out.
+     */
+    for (const std::size_t treeSize : {(std::size_t{1} << 16) + 1, (std::size_t{1} << 16) + 4096}) {
+        MerkleTree<Sha256Hasher> tree;
+        std::vector<std::string> dataValues(treeSize);
+
+        for (std::size_t i = 0; i < treeSize; i++) {
+            dataValues[i] = "data " + std::to_string(i);
+        }
+        tree.addHashesOf(dataValues);
+
+        const Sha256Digest rootHash = tree.getRootHash();
+        const std::size_t lastLeafNodeIndex = treeSize - 1;
+        const MerkleTree<Sha256Hasher>::proof_t lastProof = tree.generateProof(lastLeafNodeIndex);
+        const std::string name = std::to_string(treeSize) + " leaves, last leaf, " +
+                                 std::to_string(lastProof.siblingHashes.size()) + " hashes";
+
+        BENCHMARK("generateProof, " + name) {
+            return tree.generateProof(lastLeafNodeIndex);
+        };
+
+        BENCHMARK("verifyProof, " + name) {
+            return verifyProof<Sha256Hasher>(rootHash, lastProof, dataValues[lastLeafNodeIndex]);
+        };
+    }
+}
+
+TEST_CASE("Proof generation with different node layouts", "[benchmark]") {
+    /**
+     * 2^24 leaves take up 256 MiB of 8-byte hashes in every layout, more than the last-level cache of most CPUs, so
+     * the sibling hashes of a random leaf mostly have to come from memory. The contents of the buffers do not matter
+     * for the access pattern, so they hold arbitrary values instead of actual hashes.
+     */
+    const std::size_t treeHeight = 24;
+    std::mt19937_64 generator(treeHeight);
+    std::uniform_int_distribution<std::size_t> distribution(0, (std::size_t{1} << treeHeight) - 1);
+
+    std::vector<std::size_t> leafNodeIndexes(1024);
+    for (std::size_t &leafNodeIndex : leafNodeIndexes) {
+        leafNodeIndex = distribution(generator);
+    }
+
+    for (const NodeLayout &layout : nodeLayouts) {
+        std::vector<hash_t> nodeHashes(layout.getBufferSize(treeHeight));
+        for (std::size_t i = 0; i < nodeHashes.size(); i++) {
+            nodeHashes[i] = i;
+        }
+
+        std::size_t nextIndex = 0;
+
+        BENCHMARK("Proof, 2^24 leaves, " + std::string(layout.name)) {
+            nextIndex = (nextIndex + 1) % leafNodeIndexes.size();
+            const std::size_t leafNodeIndex = leafNodeIndexes[nextIndex];
+
+            hash_t proofChecksum = 0;
+            for (std::size_t level = 0; level < treeHeight; level++) {
+                proofChecksum ^= nodeHashes[layout.getPosition(treeHeight, level, (leafNodeIndex >> level) ^ 1)];
+            }
+
+            return proofChecksum;
+        };
+    }
+}
+
+TEST_CASE("Batch proof verification", "[benchmark]") {
+    const std::size_t treeSize = std::size_t{1} << 16;
+    const std::size_t proofCount = std::size_t{1} << 12;
+    std::vector<std::string> dataValues(treeSize);
+
+    for (std::size_t i = 0; i < treeSize; i++) {
+        dataValues[i] = "data " + std::to_string(i);
+    }
+
+    MerkleTree<Sha256Hasher> tree;
+    tree.addHashesOf(dataValues);
+    const Sha256Digest rootHash = tree.getRootHash();
+
+    std::mt19937_64 generator(proofCount);
+    std::uniform_int_distribution<std::size_t> distribution(0, treeSize - 1);
+    std::vector<MerkleTree<Sha256Hasher>::proof_t> proofs;
+    std::vector<std::string> proofData;
+
+    for (std::size_t i = 0; i < proofCount; i++) {
+        const std::size_t leafNodeIndex = distribution(generator);
+        proofs.push_back(tree.generateProof(leafNodeIndex));
+        proofData.push_back(dataValues[leafNodeIndex]);
+    }
+
+    BENCHMARK("verifyProof in a loop, 2^12 SHA-256 proofs of 2^16 leaves") {
+        std::size_t validCount = 0;
+        for (std::size_t i = 0; i < proofCount; i++) {
+            validCount += verifyProof<Sha256Hasher>(rootHash, proofs[i], proofData[i]);
+        }
+
+        return validCount;
+    };
+
+    BENCHMARK("verifyProofs, 2^12 SHA-256 proofs of 2^16 leaves") {
+        return verifyProofs<Sha256Hasher>(rootHash, proofs, proofData);
+    };
+}
+
+TEST_CASE("Multiproofs for many leaves", "[benchmark]") {
+    const std::size_t treeSize = std::size_t{1} << 20;
+    const std::size_t leafCount = 1000;
+    std::vector<std::string> dataValues(treeSize);
+
+    for (std::size_t i = 0; i < treeSize; i++) {
+        dataValues[i] = "data " + std::to_string(i);
+    }
+
+    MerkleTree<Sha256Hasher> tree;
+    tree.addHashesOf(dataValues);
+    const Sha256Digest rootHash = tree.getRootHash();
+
+    /**
+     * Sorted random indexes, so that the separate proofs and the multiproof take the data in the same order.
+     */
+    std::mt19937_64 generator(leafCount);
+    std::uniform_int_distribution<std::size_t> distribution(0, treeSize - 1);
+    std::set<std::size_t> indexSet;
+
+    while (indexSet.size() < leafCount) {
+        indexSet.insert(distribution(generator));
+    }
+
+    const std::vector<std::size_t> indexes(indexSet.begin(), indexSet.end());
+    std::vector<std::string> proofData;
+    std::vector<MerkleTree<Sha256Hasher>::proof_t> proofs;
+
+    for (const std::size_t i : indexes) {
+        proofData.push_back(dataValues[i]);
+        proofs.push_back(tree.generateProof(i));
+    }
+
+    const MerkleTree<Sha256Hasher>::multi_proof_t multiProof = tree.generateMultiProof(indexes);
+    const std::string separateHashCount = std::to_string(leafCount * tree.getTreeHeight());
+    const std::string multiHashCount = std::to_string(multiProof.siblingHashes.size());
+
+    BENCHMARK("generateProof in a loop, 1000 random leaves of 2^20, " + separateHashCount + " hashes") {
+        std::vector<MerkleTree<Sha256Hasher>::proof_t> generatedProofs;
+        for (const std::size_t i : indexes) {
+            generatedProofs.push_back(tree.generateProof(i));
+        }
+
+        return generatedProofs;
+    };
+
+    BENCHMARK("generateMultiProof, 1000 random leaves of 2^20, " + multiHashCount + " hashes") {
+        return tree.generateMultiProof(indexes);
+    };
+
+    BENCHMARK("verifyProofs, 1000 random leaves of 2^20") {
+        return verifyProofs<Sha256Hasher>(rootHash, proofs, proofData);
+    };
+
+    BENCHMARK("verifyMultiProof, 1000 random leaves of 2^20") {
+        return verifyMultiProof<Sha256Hasher>(rootHash, multiProof, proofData);
+    };
+}
+
+TEST_CASE("Range proofs for a block of leaves", "[benchmark]") {
+    const std::size_t treeSize = std::size_t{1} << 20;
+    const std::size_t firstLeafNodeIndex = 123456;
+    const std::size_t leafCount = 1000;
+    std::vector<std::string> dataValues(treeSize);
+
+    for (std::size_t i = 0; i < treeSize; i++) {
+        dataValues[i] = "data " + std::to_string(i);
+    }
+
+    MerkleTree<Sha256Hasher> tree;
+    tree.addHashesOf(dataValues);
+    const Sha256Digest rootHash = tree.getRootHash();
+
+    const std::span<const std::string> rangeData = std::span(dataValues).subspan(firstLeafNodeIndex, leafCount);
+    std::vector<MerkleTree<Sha256Hasher>::proof_t> proofs;
+
+    for (std::size_t i = firstLeafNodeIndex; i < firstLeafNodeIndex + leafCount; i++) {
+        proofs.push_back(tree.generateProof(i));
+    }
+
+    const MerkleTree<Sha256Hasher>::range_proof_t rangeProof =
+            tree.generateRangeProof(firstLeafNodeIndex, firstLeafNodeIndex + leafCount);
+    const std::string rangeHashCount =
+            std::to_string(rangeProof.leftSiblingHashes.size() + rangeProof.rightSiblingHashes.size());
+
+    BENCHMARK("generateProof in a loop, 1000 consecutive leaves of 2^20, 20000 hashes") {
+        std::vector<MerkleTree<Sha256Hasher>::proof_t> generatedProofs;
+        for (std::size_t i = firstLeafNodeIndex; i < firstLeafNodeIndex + leafCount; i++) {
+            generatedProofs.push_back(tree.generateProof(i));
+        }
+
+        return generatedProofs;
+    };
+
+    BENCHMARK("generateRangeProof, 1000 consecutive leaves of 2^20, " + rangeHashCount + " hashes") {
+        return tree.generateRangeProof(firstLeafNodeIndex, firstLeafNodeIndex + leafCount);
+    };
+
+    BENCHMARK("verifyProofs, 1000 consecutive leaves of 2^20") {
+        return verifyProofs<Sha256Hasher>(rootHash, proofs, rangeData);
+    };
+
+    BENCHMARK("verifyRangeProof, 1000 consecutive leaves of 2^20") {
+        return verifyRangeProof<Sha256Hasher>(rootHash, rangeProof, rangeData);
+    };
+}
+
+TEST_CASE("Updating leaves in place", "[benchmark]") {
+    std::vector<std::size_t> leafNodeIndexes;
+    MerkleTree tree = buildTree(20, leafNodeIndexes);
+
+    std::vector<std::pair<std::size_t, std::string>> updates;
+    for (const std::size_t leafNodeIndex : leafNodeIndexes) {
+        updates.emplace_back(leafNodeIndex, "new data " + std::to_string(leafNodeIndex));
+    }
+
+    BENCHMARK("updateLeaf in a loop, 1024 random leaves of 2^20") {
+        for (const auto &[leafNodeIndex, data] : updates) {
+            tree.updateLeaf(leafNodeIndex, data);
+        }
+
+        return tree.getRootHash();
+    };
+
+    BENCHMARK("updateLeaves, 1024 random leaves of 2^20") {
+        tree.updateLeaves(updates);
+        return tree.getRootHash();
+    };
+}
+
+TEST_CASE("Lazy root updates", "[benchmark]") {
+    std::vector<std::size_t> leafNodeIndexes;
+    const std::size_t treeHeight = 20;
+    MerkleTree tree = buildTree(treeHeight, leafNodeIndexes);
+
+    MerkleTreeOptions options;
+    options.initialHeight = treeHeight;
+    options.lazyRootUpdates = true;
+    MerkleTree lazyTree(options);
+    for (std::size_t i = 0; i < std::size_t{1} << treeHeight; i++) {
+        lazyTree.addHashOf("data " + std::to_string(i));
+    }
+
+    /**
+     * A burst of writes to a small, hot region of the tree followed by a single read of the root hash
+     */
+    std::vector<std::string> dataValues;
+    for (std::size_t i = 0; i < 1 << 14; i++) {
+        dataValues.push_back("new data " + std::to_string(i));
+    }
+
+    BENCHMARK("updateLeaf burst of 2^14 writes to 2^10 leaves of 2^20, then getRootHash, eager") {
+        for (std::size_t i = 0; i < dataValues.size(); i++) {
+            tree.updateLeaf(i % 1024, dataValues[i]);
+        }
+        return tree.getRootHash();
+    };
+
+    BENCHMARK("updateLeaf burst of 2^14 writes to 2^10 leaves of 2^20, then getRootHash, lazy") {
+        for (std::size_t i = 0; i < dataValues.size(); i++) {
+            lazyTree.updateLeaf(i % 1024, dataValues[i]);
+        }
+        return lazyTree.getRootHash();
+    };
+}
+
+TEST_CASE("Opening a tree file instead of rebuilding the tree", "[benchmark]") {
+    const std::size_t treeSize = std::size_t{1} << 20;
+    std::vector<std::string> dataValues(treeSize);
+
+    for (std::size_t i = 0; i < treeSize; i++) {
+        dataValues[i] = "data " + std::to_string(i);
+    }
+
+    MerkleTree<Sha256Hasher> tree;
+    tree.addHashesOf(dataValues);
+
+    const std::string path = (std::filesystem::temp_directory_path() / "merkle_tree_benchmarks.tree").string();
+    tree.writeToFile(path);
+
+    BENCHMARK("addHashesOf, 2^20 leaves, SHA-256, then generateProof") {
+        MerkleTree<Sha256Hasher> rebuiltTree;
+        rebuiltTree.addHashesOf(dataValues);
+        return rebuiltTree.generateProof(treeSize / 3);
+    };
+
+    BENCHMARK("MappedMerkleTree, 2^20 leaves, SHA-256, then generateProof") {
+        const MappedMerkleTree<Sha256Hasher> mappedTree(path);
+        return mappedTree.generateProof(treeSize / 3);
+    };
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Appending to a log", "[benchmark]") {
+    const std::size_t treeSize = std::size_t{1} << 20;
+    std::vector<std::string> dataValues(treeSize);
+
+    for (std::size_t i = 0; i < treeSize; i++) {
+        dataValues[i] = "data " + std::to_string(i);
+    }
+
+    BENCHMARK("MerkleTree::addHashOf, 2^20 leaves") {
+        MerkleTree tree;
+        for (const std::string &data : dataValues) {
+            tree.addHashOf(data);
+        }
+
+        return tree.getRootHash();
+    };
+
+    const std::string coldStoragePath = (std::filesystem::temp_directory_path() / "merkle_tree_benchmarks.cold").string();
+
+    BENCHMARK("AppendOnlyMerkleTree::addHashOf, 2^20 leaves") {
+        std::filesystem::remove(coldStoragePath);
+        AppendOnlyMerkleTree tree(coldStoragePath);
+        for (const std::string &data : dataValues) {
+            tree.addHashOf(data);
+        }
+
+        return tree.getRootHash();
+    };
+
+    std::filesystem::remove(coldStoragePath);
+}
+
+TEST_CASE("Consistency proofs as the tree grows", "[benchmark]") {
+    MerkleTree<Sha256Hasher> tree;
+
+    for (std::size_t treeHeight = 12; treeHeight <= 20; treeHeight += 4) {
+        const std::size_t treeSize = (std::size_t{1} << treeHeight) - 1;
+        while (tree.getTreeSize() < treeSize) {
+            tree.addHashOf("data " + std::to_string(tree.getTreeSize()));
+        }
+
+        const std::size_t oldTreeSize = treeSize / 3;
+        const Sha256Digest newRootHash = tree.getRootHash();
+        const Sha256Digest oldRootHash = [&] {
+            MerkleTree<Sha256Hasher> oldTree;
+            for (std::size_t i = 0; i < oldTreeSize; i++) {
+                oldTree.addHashOf("data " + std::to_string(i));
+            }
+            return oldTree.getRootHash();
+        }();
+        const auto proof = tree.generateConsistencyProof(oldTreeSize, treeSize);
+
+        BENCHMARK("generateConsistencyProof, 2^" + std::to_string(treeHeight) + " - 1 leaves") {
+            return tree.generateConsistencyProof(oldTreeSize, treeSize);
+        };
+
+        BENCHMARK("verifyConsistency, 2^" + std::to_string(treeHeight) + " - 1 leaves") {
+            return verifyConsistency<Sha256Hasher>(oldRootHash, newRootHash, proof);
+        };
+    }
+}
+
+TEST_CASE("Querying past tree sizes", "[benchmark]") {
+    const std::size_t treeSize = std::size_t{1} << 20;
+    std::vector<std::string> dataValues(treeSize);
+
+    for (std::size_t i = 0; i < treeSize; i++) {
+        dataValues[i] = "data " + std::to_string(i);
+    }
+
+    MerkleTree<Sha256Hasher> tree;
+    tree.addHashesOf(dataValues);
+    const std::size_t pastTreeSize = treeSize - 12345;
+
+    BENCHMARK("Copying the tree as a snapshot, 2^20 leaves") {
+        return MerkleTree<Sha256Hasher>(tree);
+    };
+
+    BENCHMARK("getRootHash at a past size, 2^20 leaves") {
+        return tree.getRootHash(pastTreeSize);
+    };
+
+    BENCHMARK("generateProof at a past size, 2^20 leaves") {
+        return tree.generateProof(pastTreeSize / 2, pastTreeSize);
+    };
+}
+
+TEST_CASE("Sparse tree of 2^16 keys", "[benchmark]") {
+    const std::size_t keyCount = std::size_t{1} << 16;
+    std::vector<SparseMerkleKey> keys(2 * keyCount);
+
+    for (std::size_t i = 0; i < keys.size(); i++) {
+        keys[i] = SparseMerkleTree<Sha256Hasher>::keyOf("key " + std::to_string(i));
+    }
+
+    SparseMerkleTree<Sha256Hasher> tree;
+    for (std::size_t i = 0; i < keyCount; i++) {
+        tree.put(keys[i], "value " + std::to_string(i));
+    }
+    const Sha256Digest rootHash = tree.getRootHash();
+    const auto inclusionProof = tree.generateProof(keys[0]);
+    const auto nonInclusionProof = tree.generateProof(keys[keyCount]);
+
+    std::size_t i = 0;
+    BENCHMARK("SparseMerkleTree::put (replacing a value), 2^16 keys") {
+        tree.put(keys[i++ % keyCount], "new value");
+    };
+
+    BENCHMARK("SparseMerkleTree::get, 2^16 keys") {
+        return tree.get(keys[i++ % keyCount]);
+    };
+
+    BENCHMARK("SparseMerkleTree::put + remove (a new key), 2^16 keys") {
+        tree.put(keys[keyCount + i % keyCount], "value");
+        return tree.remove(keys[keyCount + i++ % keyCount]);
+    };
+
+    BENCHMARK("SparseMerkleTree::generateProof, 2^16 keys") {
+        return tree.generateProof(keys[i++ % keyCount]);
+    };
+
+    BENCHMARK("verifySparseInclusion, 2^16 keys") {
+        return verifySparseInclusion<Sha256Hasher>(rootHash, keys[0], "value 0", inclusionProof);
+    };
+
+    BENCHMARK("verifySparseNonInclusion, 2^16 keys") {
+        return verifySparseNonInclusion<Sha256Hasher>(rootHash, keys[keyCount], nonInclusionProof);
+    };
+}
+
+/**
+ * Benchmark proofs in a tree of the given arity with the given data. Wider nodes mean fewer levels to walk (and fewer
+ * nodes to read from disk for trees that do not fit into memory), but more sibling hashes per level.
+ */
+template<std::size_t Arity>
+static void benchmarkKaryProofs(const std::vector<std::string> &dataValues,
+                                const std::vector<std::size_t> &leafNodeIndexes) {
+    KaryMerkleTree<Arity, Sha256Hasher> tree;
+    tree.addHashesOf(dataValues);
+    const Sha256Digest rootHash = tree.getRootHash();
+
+    const auto proof = tree.generateProof(leafNodeIndexes.front());
+    const std::string description = "arity " + std::to_string(Arity) + " (" + std::to_string(tree.getTreeHeight())
+                                    + " levels, " + std::to_string(proof.siblingHashes.size() * sizeof(Sha256Digest))
+                                    + " proof bytes)";
+
+    std::size_t i = 0;
+    BENCHMARK("generateProof, 2^20 leaves, " + description) {
+        return tree.generateProof(leafNodeIndexes[i++ % leafNodeIndexes.size()]);
+    };
+
+    BENCHMARK("verifyKaryProof, 2^20 leaves, " + description) {
+        return verifyKaryProof<Arity, Sha256Hasher>(rootHash, proof, dataValues[leafNodeIndexes.front()]);
+    };
+
+    BENCHMARK("addHashesOf, 2^16 leaves, " + description) {
+        KaryMerkleTree<Arity, Sha256Hasher> smallTree;
+        smallTree.addHashesOf(std::span(dataValues).first(std::size_t{1} << 16));
+        return smallTree.getRootHash();
+    };
+}
+
+TEST_CASE("Proof size against latency for each arity", "[benchmark]") {
+    const std::size_t treeSize = std::size_t{1} << 20;
+    std::vector<std::string> dataValues(treeSize);
+
+    for (std::size_t i = 0; i < treeSize; i++) {
+        dataValues[i] = "data " + std::to_string(i);
+    }
+
+    std::mt19937_64 generator(42);
+    std::vector<std::size_t> leafNodeIndexes(1024);
+    for (std::size_t &leafNodeIndex: leafNodeIndexes) {
+        leafNodeIndex = generator() % treeSize;
+    }
+
+    benchmarkKaryProofs<2>(dataValues, leafNodeIndexes);
+    benchmarkKaryProofs<4>(dataValues, leafNodeIndexes);
+    benchmarkKaryProofs<8>(dataValues, leafNodeIndexes);
+    benchmarkKaryProofs<16>(dataValues, leafNodeIndexes);
+}
+
+TEST_CASE("Merkle Patricia trie of 2^16 keys", "[benchmark]") {
+    const std::size_t keyCount = std::size_t{1} << 16;
+    std::vector<std::string> keys(keyCount);
+
+    for (std::size_t i = 0; i < keyCount; i++) {
+        keys[i] = "account " + std::to_string(i * 2654435761u % 1000000007u);
+    }
+
+    MerklePatriciaTrie<Sha256Hasher> trie;
+    for (std::size_t i = 0; i < keyCount; i++) {
+        trie.put(keys[i], "balance " + std::to_string(i));
+    }
+    const Sha256Digest rootHash = trie.getRootHash();
+    const auto proof = trie.generateProof(keys[0]);
+
+    std::vector<std::pair<std::string, std::optional<std::string>>> changes;
+    for (std::size_t i = 0; i < 1000; i++) {
+        changes.emplace_back(keys[i * 65], "new balance " + std::to_string(i));
+    }
+
+    BENCHMARK("1000 changes, root hash read after every change, 2^16 keys") {
+        for (const auto &[key, value]: changes) {
+            trie.put(key, *value);
+            (void) trie.getRootHash();
+        }
+        return trie.getRootHash();
+    };
+
+    BENCHMARK("1000 changes in one batch, 2^16 keys") {
+        trie.update(changes);
+        return trie.getRootHash();
+    };
+
+    std::size_t i = 0;
+    BENCHMARK("MerklePatriciaTrie::get, 2^16 keys") {
+        return trie.get(keys[i++ % keyCount]);
+    };
+
+    BENCHMARK("MerklePatriciaTrie::generateProof, 2^16 keys") {
+        return trie.generateProof(keys[i++ % keyCount]);
+    };
+
+    BENCHMARK("verifyTrieInclusion, 2^16 keys") {
+        return verifyTrieInclusion<Sha256Hasher>(rootHash, keys[0], "balance 0", proof);
+    };
+}
+
+TEST_CASE("Absence proofs in a sorted tree", "[benchmark]") {
+    const std::size_t keyCount = std::size_t{1} << 20;
+    std::vector<std::string> keys(keyCount);
+
+    for (std::size_t i = 0; i < keyCount; i++) {
+        keys[i] = "key " + std::to_string(2 * i);
+    }
+
+    SortedMerkleTree<Sha256Hasher> tree;
+    tree.insert(keys);
+    const Sha256Digest rootHash = tree.getRootHash();
+
+    const std::string missingKey = "key " + std::to_string(keyCount + 1);
+    const auto absenceProof = tree.generateAbsenceProof(missingKey);
+
+    BENCHMARK("SortedMerkleTree::generateAbsenceProof, 2^20 keys") {
+        return tree.generateAbsenceProof(missingKey);
+    };
+
+    BENCHMARK("verifyAbsence, 2^20 keys") {
+        return verifyAbsence<Sha256Hasher>(rootHash, missingKey, absenceProof);
+    };
+
+    BENCHMARK("SortedMerkleTree::insert, key greater than all the others, 2^20 keys") {
+        return tree.insert("z" + std::to_string(tree.getTreeSize()));
+    };
+}
+
+TEST_CASE("Bulk loading with multiple threads", "[benchmark]") {
+    const std::size_t treeSize = std::size_t{1} << 24;
+    std::vector<std::string> dataValues(treeSize);
+
+    for (std::size_t i = 0; i < treeSize; i++) {
+        dataValues[i] = "data " + std::to_string(i);
+    }
+
+    BENCHMARK("MerkleStreamBuilder, 2^24 leaves") {
+        MerkleStreamBuilder builder;
+        for (const std::string &data : dataValues) {
+            builder.addHashOf(data);
+        }
+
+        return builder.getRootHash();
+    };
+
+    for (const std::size_t threadCount : {1u, 2u, 4u, std::thread::hardware_concurrency()}) {
+        BENCHMARK("addHashesOf, 2^24 leaves, " + std::to_string(threadCount) + " threads") {
+            MerkleTreeOptions options;
+            options.threadCount = threadCount;
+            MerkleTree tree(options);
+
+            tree.addHashesOf(dataValues);
+            return tree.getRootHash();
+        };
+    }
+}
+
+TEST_CASE("SHA-256 pair hashing kernels", "[benchmark]") {
+    const std::size_t pairCount = std::size_t{1} << 14;
+    std::vector<Sha256Digest> children(2 * pairCount);
+    std::vector<Sha256Digest> parents(pairCount);
+
+    for (std::size_t i = 0; i < children.size(); i++) {
+        children[i] = sha256("child " + std::to_string(i));
+    }
+
+    const std::pair<Sha256Kernel, const char *> kernels[] = {
+        {Sha256Kernel::scalar, "scalar"}, {Sha256Kernel::sse41, "SSE4.1 (4 lanes)"}, {Sha256Kernel::avx2, "AVX2 (8 lanes)"},
+        {Sha256Kernel::avx512, "AVX-512 (16 lanes)"}, {Sha256Kernel::shaNi, "SHA extensions"},
+    };
+
+    for (const auto &[kernel, kernelName] : kernels) {
+        if (!isSha256KernelSupported(kernel)) {
+            continue;
+        }
+
+        BENCHMARK("sha256Pairs, 2^14 pairs, " + std::string(kernelName)) {
+            sha256Pairs(nodeHashPrefix, children, parents, kernel);
+            return parents.front();
+        };
+    }
+
+    std::vector<std::string> dataValues(pairCount);
+    for (std::size_t i = 0; i < pairCount; i++) {
+        dataValues[i] = "data " + std::to_string(i);
+    }
+
+    BENCHMARK("addHashesOf, 2^14 leaves, SHA-256") {
+        MerkleTree<Sha256Hasher> tree;
+        tree.addHashesOf(dataValues);
+        return tree.getRootHash();
+    };
+}
@@ -13,3 +13,31 @@ struct MerkleNodeIndexOutOfRangeException final : std::runtime_error {
 struct MerkleTreeEmptyException final : std::runtime_error {
     MerkleTreeEmptyException() : std::runtime_error("Merkle tree is empty") {}
 };
+
+struct MerkleTreeHeightOutOfRangeException final : std::runtime_error {
+    MerkleTreeHeightOutOfRangeException() : std::runtime_error("Tree height out of range") {}
+};
+
+struct MerkleTreeSizeOutOfRangeException final : std::runtime_error {
+    MerkleTreeSizeOutOfRangeException() : std::runtime_error("Tree size out of range") {}
+};
+
+struct MerkleKeyNotFoundException final : std::runtime_error {
+    MerkleKeyNotFoundException() : std::runtime_error("Key is not in the tree") {}
+};
+
+struct MerkleKeyFoundException final : std::runtime_error {
+    MerkleKeyFoundException() : std::runtime_error("Key is in the tree") {}
+};
+
+struct MerkleProofCountMismatchException final : std::runtime_error {
+    MerkleProofCountMismatchException() : std::runtime_error("Number of proofs does not match the number of data values") {}
+};
+
+struct MerkleTreeFileAccessException final : std::runtime_error {
+    MerkleTreeFileAccessException() : std::runtime_error("Cannot access tree file") {}
+};
+
+struct MerkleTreeFileFormatException final : std::runtime_error {
+    MerkleTreeFileFormatException() : std::runtime_error("Invalid tree file") {}
+};
@@ -0,0 +1,388 @@
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "merkle_tree_exceptions.hpp"
+#include "merkle_tree_file.hpp"
+
+
+namespace {
+
+constexpr std::uint64_t fnvOffsetBasis = 0xcbf29ce484222325;
+constexpr std::uint64_t fnvPrime = 0x100000001b3;
+
+[[nodiscard]] std::uint64_t fnv1a(std::uint64_t hash, const std::span<const std::byte> bytes) noexcept {
+    for (const std::byte byte : bytes) {
+        hash = (hash ^ static_cast<std::uint64_t>(byte)) * fnvPrime;
+    }
+
+    return hash;
+}
+
+/**
+ * The same as `fnv1a`, but 8 bytes at a time, so that checking the node arrays of a large file does not take much
+ * longer than reading them. The rotation carries the high bits of every word down into the low bits of the next
+ * step, which a plain multiplication would not do.
+ */
+[[nodiscard]] std::uint64_t fnv1aWords(std::uint64_t hash, const std::span<const std::byte> bytes) noexcept {
+    std::size_t offset = 0;
+
+    for (; offset + sizeof(std::uint64_t) <= bytes.size(); offset += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes.data() + offset, sizeof(word));
+        hash = std::rotl((hash ^ word) * fnvPrime, 29);
+    }
+
+    return fnv1a(hash, bytes.subspan(offset));
+}
+
+/**
+ * Write all the given bytes at the given offset, or at the file position if it is negative, retrying after partial and
+ * interrupted writes.
+ */
+[[nodiscard]] bool writeAll(const int fileDescriptor, std::span<const std::byte> bytes, off_t offset = -1) noexcept {
+    while (!bytes.empty()) {
+        const ssize_t writtenCount = offset < 0 ? ::write(fileDescriptor, bytes.data(), bytes.size())
+                                                : ::pwrite(fileDescriptor, bytes.data(), bytes.size(), offset);
+        if (writtenCount < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (writtenCount < 0) {
+            return false;
+        }
+
+        bytes = bytes.subspan(static_cast<std::size_t>(writtenCount));
+        offset = offset < 0 ? offset : offset + writtenCount;
+    }
+
+    return true;
+}
+
+/**
+ * Read exactly the given number of bytes from the given offset, retrying after partial and interrupted reads.
+ */
+[[nodiscard]] bool readAll(const int fileDescriptor, std::span<std::byte> bytes, off_t offset) noexcept {
+    while (!bytes.empty()) {
+        const ssize_t readCount = ::pread(fileDescriptor, bytes.data(), bytes.size(), offset);
+        if (readCount < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (readCount <= 0) {
+            return false;
+        }
+
+        bytes = bytes.subspan(static_cast<std::size_t>(readCount));
+        offset += readCount;
+    }
+
+    return true;
+}
+
+}
+
+std::uint64_t computeTreeFileChecksum(const MerkleTreeFileHeader &header,
+                                      const std::span<const std::byte> nodeHashes) noexcept {
+    MerkleTreeFileHeader checkedHeader = header;
+    checkedHeader.checksum = 0;
+
+    const std::uint64_t headerHash = fnv1a(fnvOffsetBasis, std::as_bytes(std::span(&checkedHeader, 1)));
+    if (header.treeSize == 0) {
+        return headerHash;
+    }
+
+    /**
+     * The root node is at position 2^(storageHeight - treeHeight) in heap order (see MerkleTreeFileHeader).
+     */
+    const auto treeHeight = static_cast<std::size_t>(std::bit_width(header.treeSize - 1));
+    const std::size_t rootPosition = std::size_t{1} << (header.storageHeight - treeHeight);
+    return fnv1a(headerHash, nodeHashes.subspan(rootPosition * header.digestSize, header.digestSize));
+}
+
+std::uint64_t computeTreeFileNodeChecksum(const std::span<const std::byte> nodeHashes) noexcept {
+    return fnv1aWords(fnvOffsetBasis, nodeHashes);
+}
+
+namespace {
+
+/**
+ * Write a tree file under the temporary name `path` + ".tmp" and flush it to disk. The checksum in the header is filled
+ * in here.
+ *
+ * @return the temporary name
+ */
+[[nodiscard]] std::string writeTemporaryTreeFile(const std::string &path, MerkleTreeFileHeader header,
+                                                 const std::span<const std::byte> nodeHashes) {
+    header.nodeChecksum = computeTreeFileNodeChecksum(nodeHashes);
+    header.checksum = computeTreeFileChecksum(header, nodeHashes);
+
+    std::string temporaryPath = path + ".tmp";
+    const int fileDescriptor = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fileDescriptor < 0) {
+        throw MerkleTreeFileAccessException();
+    }
+
+    const bool isWritten = writeAll(fileDescriptor, std::as_bytes(std::span(&header, 1))) &&
+                           writeAll(fileDescriptor, nodeHashes) && ::fsync(fileDescriptor) == 0;
+
+    if (::close(fileDescriptor) != 0 || !isWritten) {
+        ::unlink(temporaryPath.c_str());
+        throw MerkleTreeFileAccessException();
+    }
+
+    return temporaryPath;
+}
+
+/**
+ * Move the file written by `writeTemporaryTreeFile` to `path`, removing it if that fails.
+ */
+void renameTemporaryTreeFile(const std::string &temporaryPath, const std::string &path) {
+    if (::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        ::unlink(temporaryPath.c_str());
+        throw MerkleTreeFileAccessException();
+    }
+}
+
+}
+
+void writeTreeFile(const std::string &path, const MerkleTreeFileHeader header,
+                   const std::span<const std::byte> nodeHashes) {
+    renameTemporaryTreeFile(writeTemporaryTreeFile(path, header, nodeHashes), path);
+    syncTreeFileDirectory(path);
+}
+
+MappedTreeFile replaceTreeFile(const std::string &path, const MerkleTreeFileHeader header,
+                               const std::span<const std::byte> nodeHashes) {
+    const std::string temporaryPath = writeTemporaryTreeFile(path, header, nodeHashes);
+
+    /**
+     * The file descriptor and the mapping refer to the file itself rather than to its name, so the file stays open
+     * and mapped after the rename.
+     */
+    std::optional<MappedTreeFile> file;
+    try {
+        file.emplace(temporaryPath, true);
+    } catch (...) {
+        ::unlink(temporaryPath.c_str());
+        throw;
+    }
+
+    renameTemporaryTreeFile(temporaryPath, path);
+    return std::move(*file);
+}
+
+void syncTreeFileDirectory(const std::string &path) {
+    const std::filesystem::path directoryPath = std::filesystem::path(path).parent_path();
+    const int directoryDescriptor = ::open(directoryPath.empty() ? "." : directoryPath.c_str(),
+                                           O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directoryDescriptor < 0) {
+        throw MerkleTreeFileAccessException();
+    }
+
+    const bool isSynced = ::fsync(directoryDescriptor) == 0;
+
+    if (::close(directoryDescriptor) != 0 || !isSynced) {
+        throw MerkleTreeFileAccessException();
+    }
+}
+
+MappedTreeFile::MappedTreeFile(std::string path, const bool isWritable)
+    : path(std::move(path)), isWritable(isWritable) {
+    fileDescriptor = ::open(this->path.c_str(), (isWritable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fileDescriptor < 0) {
+        throw MerkleTreeFileAccessException();
+    }
+
+    /**
+     * The header is read with a regular read first, since the size of the mapping depends on it. Heights of 48 and more
+     * are rejected, as the size of such a tree would not even fit into the address space.
+     */
+    MerkleTreeFileHeader header;
+    struct stat fileStatus {};
+
+    if (::fstat(fileDescriptor, &fileStatus) != 0) {
+        close();
+        throw MerkleTreeFileAccessException();
+    }
+
+    const auto fileSize = static_cast<std::size_t>(fileStatus.st_size);
+
+    if (fileSize < sizeof(header) || !readAll(fileDescriptor, std::as_writable_bytes(std::span(&header, 1)), 0) ||
+        header.magic != merkleTreeFileMagic || header.digestSize == 0 || header.storageHeight >= 48 ||
+        header.treeSize > (std::uint64_t{1} << header.storageHeight) ||
+        (fileSize - sizeof(header)) / header.digestSize < (std::size_t{2} << header.storageHeight)) {
+        close();
+        throw MerkleTreeFileFormatException();
+    }
+
+    digestSize = header.digestSize;
+    mappingSize = sizeof(header) + (std::size_t{2} << header.storageHeight) * digestSize;
+    mapping = ::mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        close();
+        throw MerkleTreeFileAccessException();
+    }
+
+    if (computeTreeFileChecksum(header, getNodeHashes()) != header.checksum) {
+        close();
+        throw MerkleTreeFileFormatException();
+    }
+
+    const std::size_t writeAheadSize = (fileSize - mappingSize) / digestSize * digestSize;
+    writeAheadEnd = mappingSize + writeAheadSize;
+    writeAheadRecords.resize(writeAheadSize);
+
+    if (!readAll(fileDescriptor, writeAheadRecords, static_cast<off_t>(mappingSize)) ||
+        (isWritable && ::ftruncate(fileDescriptor, static_cast<off_t>(writeAheadEnd)) != 0)) {
+        close();
+        throw MerkleTreeFileAccessException();
+    }
+}
+
+MappedTreeFile::MappedTreeFile(MappedTreeFile &&other) noexcept
+    : path(std::move(other.path)), fileDescriptor(std::exchange(other.fileDescriptor, -1)),
+      isWritable(other.isWritable), mapping(std::exchange(other.mapping, nullptr)), mappingSize(other.mappingSize),
+      digestSize(other.digestSize), writeAheadRecords(std::move(other.writeAheadRecords)),
+      writeAheadEnd(other.writeAheadEnd) {}
+
+MappedTreeFile &MappedTreeFile::operator=(MappedTreeFile &&other) noexcept {
+    if (this != &other) {
+        close();
+        path = std::move(other.path);
+        fileDescriptor = std::exchange(other.fileDescriptor, -1);
+        isWritable = other.isWritable;
+        mapping = std::exchange(other.mapping, nullptr);
+        mappingSize = other.mappingSize;
+        digestSize = other.digestSize;
+        writeAheadRecords = std::move(other.writeAheadRecords);
+        writeAheadEnd = other.writeAheadEnd;
+    }
+
+    return *this;
+}
+
+MappedTreeFile::~MappedTreeFile() {
+    close();
+}
+
+void MappedTreeFile::close() noexcept {
+    if (mapping != nullptr) {
+        ::munmap(mapping, mappingSize);
+        mapping = nullptr;
+    }
+
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+}
+
+void MappedTreeFile::makeWritable() {
+    const int writableDescriptor = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (writableDescriptor < 0) {
+        throw MerkleTreeFileAccessException();
+    }
+
+    /**
+     * The file may have been replaced since it was opened, in which case the mapping no longer belongs to `path`.
+     */
+    struct stat openedStatus {}, writableStatus {};
+
+    if (::fstat(fileDescriptor, &openedStatus) != 0 || ::fstat(writableDescriptor, &writableStatus) != 0 ||
+        openedStatus.st_dev != writableStatus.st_dev || openedStatus.st_ino != writableStatus.st_ino ||
+        ::ftruncate(writableDescriptor, static_cast<off_t>(writeAheadEnd)) != 0) {
+        ::close(writableDescriptor);
+        throw MerkleTreeFileAccessException();
+    }
+
+    ::close(std::exchange(fileDescriptor, writableDescriptor));
+    isWritable = true;
+}
+
+void MappedTreeFile::verifyNodeHashes() const {
+    if (computeTreeFileNodeChecksum(getNodeHashes()) != getHeader().nodeChecksum) {
+        throw MerkleTreeFileFormatException();
+    }
+}
+
+void MappedTreeFile::appendWriteAheadRecord(const std::span<const std::byte> record) {
+    if (!isWritable) {
+        makeWritable();
+    }
+
+    /**
+     * A record that was only partly written (or not flushed) is cut off again, so that the file matches the tree, which
+     * is not changed. Even if the file cannot be truncated, the next record is written where this one started.
+     */
+    if (!writeAll(fileDescriptor, record, static_cast<off_t>(writeAheadEnd)) || ::fdatasync(fileDescriptor) != 0) {
+        (void) ::ftruncate(fileDescriptor, static_cast<off_t>(writeAheadEnd));
+        throw MerkleTreeFileAccessException();
+    }
+
+    writeAheadEnd += record.size();
+}
+
+ColdStorageFile::ColdStorageFile(const std::string &path, const ColdStorageOpenMode mode) {
+    const int flags = mode == ColdStorageOpenMode::create ? O_RDWR | O_CREAT | O_CLOEXEC : O_RDWR | O_CLOEXEC;
+    fileDescriptor = ::open(path.c_str(), flags, 0644);
+    if (fileDescriptor < 0) {
+        throw MerkleTreeFileAccessException();
+    }
+
+    struct stat fileStatus {};
+
+    if (::fstat(fileDescriptor, &fileStatus) != 0 || (mode == ColdStorageOpenMode::create && fileStatus.st_size != 0)) {
+        ::close(fileDescriptor);
+        throw MerkleTreeFileAccessException();
+    }
+
+    fileSize = static_cast<std::uint64_t>(fileStatus.st_size);
+}
+
+ColdStorageFile::ColdStorageFile(ColdStorageFile &&other) noexcept
+    : fileDescriptor(std::exchange(other.fileDescriptor, -1)), fileSize(other.fileSize) {}
+
+ColdStorageFile &ColdStorageFile::operator=(ColdStorageFile &&other) noexcept {
+    if (this != &other) {
+        if (fileDescriptor >= 0) {
+            ::close(fileDescriptor);
+        }
+
+        fileDescriptor = std::exchange(other.fileDescriptor, -1);
+        fileSize = other.fileSize;
+    }
+
+    return *this;
+}
+
+ColdStorageFile::~ColdStorageFile() {
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+    }
+}
+
+void ColdStorageFile::append(const std::span<const std::byte> bytes) {
+    const auto offset = static_cast<off_t>(fileSize);
+
+    if (!writeAll(fileDescriptor, bytes, offset)) {
+        (void) ::ftruncate(fileDescriptor, offset);
+        throw MerkleTreeFileAccessException();
+    }
+
+    fileSize += bytes.size();
+}
+
+void ColdStorageFile::read(const std::span<std::byte> bytes, const std::uint64_t offset) const {
+    if (offset + bytes.size() > fileSize || !readAll(fileDescriptor, bytes, static_cast<off_t>(offset))) {
+        throw MerkleTreeFileAccessException();
+    }
+}
@@ -0,0 +1,261 @@
+#pragma once
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "merkle_tree_hashers.hpp"
+
+
+/**
+ * A hash function policy whose trees can be stored in a tree file. On top of MerkleHasher, the policy has to identify
+ * itself with a `hasherId` (so that a file is never read with a different hash function than it was written with) and
+ * its digests have to be trivially copyable, so that they can be stored as raw bytes.
+ */
+template<typename Hasher>
+concept PersistentMerkleHasher = MerkleHasher<Hasher> && std::is_trivially_copyable_v<typename Hasher::digest_type> &&
+    requires {
+        { Hasher::hasherId } -> std::convertible_to<std::uint32_t>;
+    };
+
+static constexpr std::array<char, 8> merkleTreeFileMagic = {'M', 'E', 'R', 'K', 'L', 'E', '0', '4'};
+
+/**
+ * The header at the start of a tree file. A tree file consists of:
+ *
+ * - the header,
+ * - the hashes of all the stored nodes of the tree in the heap order used by MerkleTree (the topmost node at position 1,
+ *   the children of position p at 2p and 2p + 1, each level a contiguous array; position 0 is unused), i.e.
+ *   2^(storageHeight + 1) digests of `digestSize` bytes,
+ * - the write-ahead region: the leaf hashes appended since the file was written, one digest each, in order.
+ *
+ * All the numbers (and the digests themselves) are in the byte order of the machine that wrote the file.
+ */
+struct MerkleTreeFileHeader {
+    std::array<char, 8> magic = merkleTreeFileMagic;
+
+    std::uint32_t hasherId = 0;
+
+    std::uint32_t digestSize = 0;
+
+    std::uint64_t storageHeight = 0;
+
+    /**
+     * Number of hashes in the tree when the file was written, not counting the write-ahead region.
+     */
+    std::uint64_t treeSize = 0;
+
+    /**
+     * FNV-1a hash of all the node arrays (see `computeTreeFileNodeChecksum`). It is only checked on request (see
+     * `MappedTreeFile::verifyNodeHashes`), since that reads the whole file.
+     */
+    std::uint64_t nodeChecksum = 0;
+
+    /**
+     * FNV-1a hash of the rest of the header and of the root node (see `computeTreeFileChecksum`), checked whenever the
+     * file is opened. The write-ahead region is not covered, as it changes with every record.
+     */
+    std::uint64_t checksum = 0;
+
+    std::array<std::uint8_t, 16> reserved = {};
+};
+
+static_assert(sizeof(MerkleTreeFileHeader) == 64 && std::is_trivially_copyable_v<MerkleTreeFileHeader>);
+
+/**
+ * @return the checksum of the given header (ignoring its checksum field) and of the root node of the tree it describes
+ * (the node on level ceil(log2(treeSize)) in the given node arrays; nothing for an empty tree).
+ */
+[[nodiscard]] std::uint64_t computeTreeFileChecksum(const MerkleTreeFileHeader &header,
+                                                    std::span<const std::byte> nodeHashes) noexcept;
+
+/**
+ * @return the checksum of the given node arrays.
+ */
+[[nodiscard]] std::uint64_t computeTreeFileNodeChecksum(std::span<const std::byte> nodeHashes) noexcept;
+
+/**
+ * Write a tree file with an empty write-ahead region, replacing the file at `path` (if any) atomically: the file is
+ * written under a temporary name, flushed to disk and then renamed, and the rename is flushed to disk as well. The
+ * checksums in the header are filled in here.
+ *
+ * @throws MerkleTreeFileAccessException if the file cannot be written
+ */
+void writeTreeFile(const std::string &path, MerkleTreeFileHeader header, std::span<const std::byte> nodeHashes);
+
+/**
+ * An open tree file. The header and the node arrays are mapped into memory read-only, so that opening a file only reads
+ * the pages that are actually accessed, and the pages are shared with the page cache instead of being copied. The
+ * write-ahead region is read once when the file is opened and appended to with regular writes.
+ *
+ * Unless it is opened for writing, the file is opened read-only and is not changed until the first record is appended,
+ * so that files without write access (or on read-only file systems) can be read.
+ */
+struct MappedTreeFile {
+
+private:
+
+    std::string path;
+
+    int fileDescriptor = -1;
+
+    bool isWritable = false;
+
+    void *mapping = nullptr;
+
+    std::size_t mappingSize = 0;
+
+    std::size_t digestSize = 0;
+
+    std::vector<std::byte> writeAheadRecords;
+
+    /**
+     * The end of the last complete record of the write-ahead region, where the next record is written.
+     */
+    std::uint64_t writeAheadEnd = 0;
+
+    void close() noexcept;
+
+    /**
+     * Reopen the file for writing (checking that `path` still refers to the same file) and cut off an incomplete record
+     * at the end of the write-ahead region.
+     * @throws MerkleTreeFileAccessException if the file cannot be opened for writing or truncated
+     */
+    void makeWritable();
+
+public:
+
+    /**
+     * Open and map the tree file at `path`, checking the magic, that the file is large enough for the node arrays and
+     * the checksum of the header and the root node (the other nodes are not read, see `verifyNodeHashes`). An
+     * incomplete record at the end of the write-ahead region (left behind by a crash while appending) is skipped, and
+     * only cut off once the file is written to.
+     *
+     * @param isWritable whether to open the file for writing right away instead of on the first append
+     * @throws MerkleTreeFileAccessException if the file cannot be opened or mapped
+     * @throws MerkleTreeFileFormatException if the file is not a valid tree file
+     */
+    explicit MappedTreeFile(std::string path, bool isWritable = false);
+
+    MappedTreeFile(MappedTreeFile &&other) noexcept;
+    MappedTreeFile &operator=(MappedTreeFile &&other) noexcept;
+    MappedTreeFile(const MappedTreeFile &) = delete;
+    MappedTreeFile &operator=(const MappedTreeFile &) = delete;
+    ~MappedTreeFile();
+
+    [[nodiscard]] const MerkleTreeFileHeader &getHeader() const noexcept {
+        return *static_cast<const MerkleTreeFileHeader *>(mapping);
+    }
+
+    /**
+     * @return the mapped node arrays, 2^(storageHeight + 1) digests in heap order.
+     */
+    [[nodiscard]] std::span<const std::byte> getNodeHashes() const noexcept {
+        const auto *mappedBytes = static_cast<const std::byte *>(mapping);
+        return {mappedBytes + sizeof(MerkleTreeFileHeader), mappingSize - sizeof(MerkleTreeFileHeader)};
+    }
+
+    /**
+     * @return the records of the write-ahead region as they were when the file was opened.
+     */
+    [[nodiscard]] std::span<const std::byte> getWriteAheadRecords() const noexcept {
+        return writeAheadRecords;
+    }
+
+    /**
+     * Check the node arrays against the node checksum in the header. This reads the whole file.
+     * @throws MerkleTreeFileFormatException if the node arrays do not match the checksum
+     */
+    void verifyNodeHashes() const;
+
+    /**
+     * Append a record to the write-ahead region and flush it to disk before returning. The first append reopens the
+     * file for writing, unless it was opened for writing.
+     * @throws MerkleTreeFileAccessException if the record cannot be written (the write-ahead region is left as it was)
+     */
+    void appendWriteAheadRecord(std::span<const std::byte> record);
+};
+
+/**
+ * Write a tree file like `writeTreeFile`, but open it before it replaces the file at `path`. If the new file cannot be
+ * written or opened, the file at `path` is left as it was, and once it has been renamed, the returned file is the one at
+ * `path`. This way, the caller never ends up with a file that has been replaced under it.
+ *
+ * The rename is not flushed to disk here, see `syncTreeFileDirectory`.
+ *
+ * @return the new file, opened and mapped
+ * @throws MerkleTreeFileAccessException if the file cannot be written, opened or mapped
+ */
+[[nodiscard]] MappedTreeFile replaceTreeFile(const std::string &path, MerkleTreeFileHeader header,
+                                             std::span<const std::byte> nodeHashes);
+
+/**
+ * Flush the directory that contains `path` to disk, so that a file renamed to `path` is still there after a crash.
+ * @throws MerkleTreeFileAccessException if the directory cannot be opened or flushed
+ */
+void syncTreeFileDirectory(const std::string &path);
+
+/**
+ * How a ColdStorageFile treats the file it opens.
+ */
+enum class ColdStorageOpenMode {
+    /**
+     * Start a new file: it is created if it does not exist, and an existing file has to be empty.
+     */
+    create,
+
+    /**
+     * Continue an existing file, appending after its current contents.
+     */
+    reopen,
+};
+
+/**
+ * A file that is only appended to and read at given offsets, such as the cold storage of an AppendOnlyMerkleTree. Reads
+ * use `pread` and do not move a shared file position, so any number of them can run at the same time.
+ */
+struct ColdStorageFile {
+
+private:
+
+    int fileDescriptor = -1;
+
+    std::uint64_t fileSize = 0;
+
+public:
+
+    /**
+     * Open the file at `path`. When creating, a file that already has contents is refused rather than truncated, so that
+     * data written by someone else is never lost.
+     *
+     * @throws MerkleTreeFileAccessException if the file cannot be opened, does not exist (when reopening) or is not
+     * empty (when creating)
+     */
+    explicit ColdStorageFile(const std::string &path, ColdStorageOpenMode mode = ColdStorageOpenMode::create);
+
+    ColdStorageFile(ColdStorageFile &&other) noexcept;
+    ColdStorageFile &operator=(ColdStorageFile &&other) noexcept;
+    ColdStorageFile(const ColdStorageFile &) = delete;
+    ColdStorageFile &operator=(const ColdStorageFile &) = delete;
+    ~ColdStorageFile();
+
+    /**
+     * Append the given bytes to the end of the file.
+     * @throws MerkleTreeFileAccessException if the bytes cannot be written (the file is truncated back to its previous
+     * size)
+     */
+    void append(std::span<const std::byte> bytes);
+
+    /**
+     * Read exactly `bytes.size()` bytes starting at `offset`.
+     * @throws MerkleTreeFileAccessException if the bytes cannot be read
+     */
+    void read(std::span<std::byte> bytes, std::uint64_t offset) const;
+
+    [[nodiscard]] std::uint64_t getSize() const noexcept {
+        return fileSize;
+    }
+};
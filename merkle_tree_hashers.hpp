@@ -0,0 +1,199 @@
+#pragma once
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <string_view>
+#include "sha256.hpp"
+
+
+/**
+ * A hash function policy for MerkleTree. The tree only ever calls the two static member functions of the policy, so the
+ * hash function is resolved at compile time and can be inlined into the loops that build the tree.
+ *
+ * - `digest_type` is the type of a hash. A value-initialized digest_type (e.g. 0 for integers) fills the room that is
+ *   reserved for nodes without any leaves yet; it is never hashed.
+ * - `hashLeaf(data)` hashes the data inserted into a leaf node.
+ * - `hashNode(left, right)` combines the hashes of the two children of a node into the hash of the node itself.
+ *
+ * `hashNode` must depend on the order of its arguments, and the leaf and node hashes must be domain separated (see
+ * `leafHashPrefix`), otherwise proofs can be forged by swapping siblings or by passing off a node as a leaf.
+ *
+ * A policy may additionally provide `hashNodes(children, parents)`, which does the same as calling hashNode for every
+ * pair of children (see `hashNodePairs`) but can hash several independent pairs at once.
+ */
+template<typename Hasher>
+concept MerkleHasher = std::regular<typename Hasher::digest_type> &&
+    requires(const std::string_view data, const typename Hasher::digest_type &digest) {
+        { Hasher::hashLeaf(data) } -> std::same_as<typename Hasher::digest_type>;
+        { Hasher::hashNode(digest, digest) } -> std::same_as<typename Hasher::digest_type>;
+    };
+
+/**
+ * The largest number of children of a node in a KaryMerkleTree, and so the largest number of hashes that
+ * `hashChildren` is called with. Keeping it small lets policies build the message in a fixed-size buffer.
+ */
+constexpr std::size_t maxKaryArity = 16;
+
+/**
+ * A hash function policy for KaryMerkleTree, which additionally provides `hashChildren(children)`: the hash of a node
+ * with 2 to `maxKaryArity` children, computed from a single message (the node hash prefix followed by all the child
+ * hashes), so that `hashChildren({left, right})` equals `hashNode(left, right)`.
+ */
+template<typename Hasher>
+concept KaryMerkleHasher = MerkleHasher<Hasher> &&
+    requires(const std::span<const typename Hasher::digest_type> children) {
+        { Hasher::hashChildren(children) } -> std::same_as<typename Hasher::digest_type>;
+    };
+
+/**
+ * The byte that the message of a leaf hash starts with, as in RFC 6962 (Certificate Transparency). The message of a
+ * node hash starts with `nodeHashPrefix` instead, so no leaf hash can equal a node hash unless the hash function
+ * itself collides, and a proof cannot present the hash of an inner node as the hash of some leaf data.
+ */
+constexpr std::uint8_t leafHashPrefix = 0x00;
+constexpr std::uint8_t nodeHashPrefix = 0x01;
+
+/**
+ * The default hash function policy, based on std::hash. It is fast, but it is not a cryptographic hash function and its
+ * results differ between standard library implementations, so it should only be used for trees that never leave the
+ * process that built them.
+ *
+ * The hash of a leaf is the hash of `leafHashPrefix` followed by the bytes of std::hash of the data (hashing the data
+ * itself after the prefix would mean copying it). The hash of a non-leaf node is the hash of `nodeHashPrefix` followed
+ * by the bytes of the left and then the right child's hash. All the messages are built in fixed-size buffers on the stack.
+ */
+struct StdHasher {
+    using digest_type = std::size_t;
+
+    /**
+     * Identifies the policy in tree files (see merkle_tree_file.hpp).
+     */
+    static constexpr std::uint32_t hasherId = 1;
+
+    [[nodiscard]] static digest_type hashLeaf(const std::string_view data) noexcept {
+        const digest_type dataHash = std::hash<std::string_view>()(data);
+
+        std::array<char, 1 + sizeof(digest_type)> message;
+        message[0] = static_cast<char>(leafHashPrefix);
+        std::memcpy(&message[1], &dataHash, sizeof(digest_type));
+
+        return std::hash<std::string_view>()(std::string_view(message.data(), message.size()));
+    }
+
+    [[nodiscard]] static digest_type hashNode(const digest_type left, const digest_type right) noexcept {
+        std::array<char, 1 + 2 * sizeof(digest_type)> message;
+        message[0] = static_cast<char>(nodeHashPrefix);
+        std::memcpy(&message[1], &left, sizeof(digest_type));
+        std::memcpy(&message[1 + sizeof(digest_type)], &right, sizeof(digest_type));
+
+        return std::hash<std::string_view>()(std::string_view(message.data(), message.size()));
+    }
+
+    /**
+     * The message is built on the stack, so `children` must hold 2 to `maxKaryArity` hashes, as KaryMerkleTree
+     * guarantees.
+     */
+    [[nodiscard]] static digest_type hashChildren(const std::span<const digest_type> children) noexcept {
+        assert(children.size() >= 2 && children.size() <= maxKaryArity);
+
+        std::array<char, 1 + maxKaryArity * sizeof(digest_type)> message;
+        message[0] = static_cast<char>(nodeHashPrefix);
+        std::memcpy(&message[1], children.data(), children.size_bytes());
+
+        return std::hash<std::string_view>()(std::string_view(message.data(), 1 + children.size_bytes()));
+    }
+};
+
+/**
+ * Hash function policy using SHA-256 with the hashing scheme of RFC 6962: the hash of a leaf is
+ * SHA-256(0x00 || data) and the hash of a non-leaf node is SHA-256(0x01 || left || right).
+ */
+struct Sha256Hasher {
+    using digest_type = Sha256Digest;
+
+    /**
+     * Identifies the policy in tree files (see merkle_tree_file.hpp).
+     */
+    static constexpr std::uint32_t hasherId = 2;
+
+    [[nodiscard]] static digest_type hashLeaf(const std::string_view data) noexcept {
+        return sha256(leafHashPrefix, data);
+    }
+
+    [[nodiscard]] static digest_type hashNode(const digest_type &left, const digest_type &right) noexcept {
+        const std::array<digest_type, 2> children = {left, right};
+        digest_type parent;
+        sha256Pairs(nodeHashPrefix, children, {&parent, 1});
+        return parent;
+    }
+
+    [[nodiscard]] static digest_type hashChildren(const std::span<const digest_type> children) noexcept {
+        return sha256(nodeHashPrefix,
+                      std::string_view(reinterpret_cast<const char *>(children.data()), children.size_bytes()));
+    }
+
+    static void hashNodes(const std::span<const digest_type> children, const std::span<digest_type> parents) noexcept {
+        sha256Pairs(nodeHashPrefix, children, parents);
+    }
+};
+
+/**
+ * Hash pairs of sibling nodes: parents[i] = Hasher::hashNode(children[2 * i], children[2 * i + 1]) for every i, using
+ * Hasher::hashNodes if the policy has it. `children` must contain exactly twice as many hashes as `parents`.
+ */
+template<MerkleHasher Hasher>
+void hashNodePairs(const std::span<const typename Hasher::digest_type> children,
+                   const std::span<typename Hasher::digest_type> parents) noexcept {
+    if constexpr (requires { Hasher::hashNodes(children, parents); }) {
+        Hasher::hashNodes(children, parents);
+    } else {
+        for (std::size_t i = 0; i < parents.size(); i++) {
+            parents[i] = Hasher::hashNode(children[2 * i], children[2 * i + 1]);
+        }
+    }
+}
+
+/**
+ * Hashes of the subtrees made only of empty leaves, one per height, for trees of a fixed height that are mostly empty
+ * (see SparseMerkleTree). An empty leaf has the placeholder hash (a value-initialized digest_type) and an empty subtree
+ * of height h is the node hash of two empty subtrees of height h - 1, so every empty subtree of the same height has the
+ * same hash. The table is computed once per hash function policy, the first time it is used, which makes any empty
+ * subtree an O(1) lookup instead of h hashes.
+ */
+template<MerkleHasher Hasher>
+struct EmptySubtreeHashes {
+
+public:
+
+    using hash_t = typename Hasher::digest_type;
+
+    /**
+     * Height of the tallest empty subtree in the table, enough for trees indexed by 256-bit keys.
+     */
+    static constexpr std::size_t maxHeight = 256;
+
+    /**
+     * @return the hash of an empty subtree of the given height (at most maxHeight).
+     */
+    [[nodiscard]] static const hash_t &get(const std::size_t height) noexcept {
+        static const std::array<hash_t, maxHeight + 1> table = computeTable();
+        return table[height];
+    }
+
+private:
+
+    [[nodiscard]] static std::array<hash_t, maxHeight + 1> computeTable() noexcept {
+        std::array<hash_t, maxHeight + 1> table{};
+
+        for (std::size_t height = 1; height <= maxHeight; height++) {
+            table[height] = Hasher::hashNode(table[height - 1], table[height - 1]);
+        }
+
+        return table;
+    }
+};
@@ -1,28 +1,298 @@
 #define CATCH_CONFIG_MAIN
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <list>
 #include <set>
 #include "catch2/catch_test_macros.hpp"
 #include "merkle_tree.hpp"
 #include "merkle_tree_exceptions.hpp"
 
 
+/**
+ * A (non-cryptographic) FNV-1a hash function policy, used for checking that the tree works with hash functions other
+ * than the default one.
+ */
+struct FnvHasher {
+    using digest_type = std::uint32_t;
+
+    static digest_type hashBytes(const std::string_view bytes) noexcept {
+        digest_type hash = 2166136261u;
+        for (const char byte : bytes) {
+            hash = (hash ^ static_cast<unsigned char>(byte)) * 16777619u;
+        }
+        return hash;
+    }
+
+    static digest_type hashLeaf(const std::string_view data) noexcept {
+        return hashBytes(data);
+    }
+
+    static digest_type hashNode(const digest_type left, const digest_type right) noexcept {
+        const std::array<digest_type, 2> children = {left, right};
+        return hashBytes({reinterpret_cast<const char *>(children.data()), sizeof(children)});
+    }
+};
+
+/**
+ * FnvHasher that counts the node hashes, used for checking when the tree hashes its non-leaf nodes.
+ */
+struct CountingHasher : FnvHasher {
+    static inline std::size_t nodeHashCount = 0;
+
+    static digest_type hashNode(const digest_type left, const digest_type right) noexcept {
+        nodeHashCount++;
+        return FnvHasher::hashNode(left, right);
+    }
+};
+
 TEST_CASE("MerkleTree", "[merkle_tree]") {
     MerkleTree tree;
 
-    SECTION("Adding 33rd node throws exception") {
-        for (int i = 0; i < treeCapacity; i++) {
+    SECTION("Adding 33rd node to a tree with a maximum height of 5 throws exception") {
+        MerkleTreeOptions options;
+        options.maxHeight = 5;
+        tree = MerkleTree(options);
+
+        for (int i = 0; i < 32; i++) {
             tree.addHashOf("data");
         }
 
         REQUIRE_THROWS_AS(tree.addHashOf("33rd data node"), MerkleTreeFullException);
     }
 
+    SECTION("Initial height greater than maximum height throws exception") {
+        MerkleTreeOptions options;
+        options.initialHeight = 6;
+        options.maxHeight = 5;
+
+        REQUIRE_THROWS_AS(MerkleTree(options), MerkleTreeHeightOutOfRangeException);
+    }
+
+    SECTION("Tree grows beyond its initial capacity") {
+        for (int i = 0; i < 1000; i++) {
+            tree.addHashOf("data " + std::to_string(i));
+        }
+
+        REQUIRE(tree.getTreeSize() == 1000);
+        REQUIRE(tree.getTreeHeight() == 10);
+        REQUIRE(verifyProof(tree.getRootHash(), tree.generateProof(999), "data 999") == true);
+    }
+
+    SECTION("Initial height does not affect the root hash") {
+        MerkleTreeOptions options;
+        options.initialHeight = 8;
+        MerkleTree preallocatedTree(options);
+
+        for (int i = 0; i < 100; i++) {
+            tree.addHashOf("data " + std::to_string(i));
+            preallocatedTree.addHashOf("data " + std::to_string(i));
+            REQUIRE(tree.getRootHash() == preallocatedTree.getRootHash());
+        }
+    }
+
+    SECTION("Adding hashes in batches gives the same root hash as adding them one by one") {
+        std::vector<std::string> dataValues;
+        for (int i = 0; i < 300; i++) {
+            dataValues.push_back("data " + std::to_string(i));
+        }
+
+        MerkleTree batchTree;
+        std::size_t batchStart = 0;
+
+        /**
+         * Batches of increasing size, so that they start and end at different offsets and some of them make the tree grow
+         */
+        for (std::size_t batchSize = 1; batchStart + batchSize <= dataValues.size(); batchSize++) {
+            batchTree.addHashesOf(std::span(dataValues).subspan(batchStart, batchSize));
+
+            for (std::size_t i = batchStart; i < batchStart + batchSize; i++) {
+                tree.addHashOf(dataValues.at(i));
+            }
+
+            batchStart += batchSize;
+            REQUIRE(batchTree.getRootHash() == tree.getRootHash());
+        }
+    }
+
+    SECTION("Adding a large batch with multiple threads gives the same root hash as with one thread") {
+        std::vector<std::string> dataValues;
+        for (int i = 0; i < 20000; i++) {
+            dataValues.push_back("data " + std::to_string(i));
+        }
+
+        MerkleTreeOptions options;
+        options.threadCount = 4;
+        MerkleTree parallelTree(options);
+
+        /**
+         * Start with a few hashes so that the batch does not start at a subtree boundary
+         */
+        for (MerkleTree<> *currentTree : {&tree, &parallelTree}) {
+            currentTree->addHashOf("first");
+            currentTree->addHashOf("second");
+            currentTree->addHashOf("third");
+            currentTree->addHashesOf(dataValues);
+        }
+
+        REQUIRE(parallelTree.getRootHash() == tree.getRootHash());
+        REQUIRE(verifyProof(parallelTree.getRootHash(), parallelTree.generateProof(12345), "data 12342") == true);
+
+        MerkleTree listTree(options);
+        const std::list<std::string> dataList(dataValues.begin(), dataValues.end());
+        listTree.addHashOf("first");
+        listTree.addHashOf("second");
+        listTree.addHashOf("third");
+        listTree.addHashesOf(dataList.begin(), dataList.end());
+        REQUIRE(listTree.getRootHash() == tree.getRootHash());
+    }
+
+    SECTION("Adding hashes from an iterator range") {
+        const std::vector<std::string_view> dataValues = {"data1", "data2", "data3"};
+        tree.addHashesOf(dataValues.begin(), dataValues.end());
+
+        REQUIRE(tree.getTreeSize() == 3);
+        REQUIRE(verifyProof(tree.getRootHash(), tree.generateProof(2), "data3") == true);
+    }
+
+    SECTION("Adding a batch that does not fit throws exception and leaves the tree unchanged") {
+        MerkleTreeOptions options;
+        options.maxHeight = 2;
+        tree = MerkleTree(options);
+        tree.addHashOf("data");
+
+        const std::vector<std::string> dataValues(4, "data");
+        REQUIRE_THROWS_AS(tree.addHashesOf(dataValues), MerkleTreeFullException);
+        REQUIRE(tree.getTreeSize() == 1);
+    }
+
+    SECTION("Updating a leaf gives the same root hash as adding the new data in the first place") {
+        MerkleTree expectedTree;
+        for (int i = 0; i < 20; i++) {
+            tree.addHashOf("data " + std::to_string(i));
+            expectedTree.addHashOf(i == 13 ? "new data" : "data " + std::to_string(i));
+        }
+
+        tree.updateLeaf(13, "new data");
+
+        REQUIRE(tree.getRootHash() == expectedTree.getRootHash());
+        REQUIRE(verifyProof(tree.getRootHash(), tree.generateProof(13), "new data") == true);
+        REQUIRE(verifyProof(tree.getRootHash(), tree.generateProof(13), "data 13") == false);
+    }
+
+    SECTION("Updating a leaf that is out of range throws exception") {
+        tree.addHashOf("data");
+
+        REQUIRE_THROWS_AS(tree.updateLeaf(1, "new data"), MerkleNodeIndexOutOfRangeException);
+    }
+
+    SECTION("Updating leaves in a batch gives the same root hash as updating them one by one") {
+        MerkleTree expectedTree;
+        std::vector<std::pair<std::size_t, std::string>> updates;
+
+        for (int i = 0; i < 100; i++) {
+            tree.addHashOf("data " + std::to_string(i));
+            expectedTree.addHashOf("data " + std::to_string(i));
+        }
+
+        for (const std::size_t leafNodeIndex : {0, 1, 7, 8, 50, 51, 52, 99, 7}) {
+            updates.emplace_back(leafNodeIndex, "new data " + std::to_string(updates.size()));
+            expectedTree.updateLeaf(leafNodeIndex, updates.back().second);
+        }
+
+        tree.updateLeaves(updates);
+
+        REQUIRE(tree.getRootHash() == expectedTree.getRootHash());
+        REQUIRE(verifyProof(tree.getRootHash(), tree.generateProof(7), "new data 8") == true);
+    }
+
+    SECTION("Updating a batch with an index out of range throws exception and leaves the tree unchanged") {
+        for (int i = 0; i < 10; i++) {
+            tree.addHashOf("data " + std::to_string(i));
+        }
+        const hash_t rootHash = tree.getRootHash();
+
+        const std::vector<std::pair<std::size_t, std::string>> updates = {{3, "new data"}, {10, "new data"}};
+
+        REQUIRE_THROWS_AS(tree.updateLeaves(updates), MerkleNodeIndexOutOfRangeException);
+        REQUIRE(tree.getRootHash() == rootHash);
+    }
+
+    SECTION("Lazy root updates give the same root hashes and proofs as eager ones") {
+        MerkleTreeOptions options;
+        options.lazyRootUpdates = true;
+        MerkleTree lazyTree(options);
+
+        std::vector<std::string> dataValues;
+        for (int i = 0; i < 300; i++) {
+            dataValues.push_back("data " + std::to_string(i));
+        }
+
+        /**
+         * Writes of every kind, including ones that make the tree grow, with reads in between
+         */
+        for (int i = 0; i < 37; i++) {
+            tree.addHashOf(dataValues[i]);
+            lazyTree.addHashOf(dataValues[i]);
+        }
+        REQUIRE(lazyTree.getRootHash() == tree.getRootHash());
+
+        tree.updateLeaf(5, "new data");
+        lazyTree.updateLeaf(5, "new data");
+        tree.addHashesOf(std::span(dataValues).subspan(37, 100));
+        lazyTree.addHashesOf(std::span(dataValues).subspan(37, 100));
+        for (int i = 137; i < 300; i++) {
+            tree.addHashOf(dataValues[i]);
+            lazyTree.addHashOf(dataValues[i]);
+        }
+        REQUIRE(lazyTree.generateProof(5).siblingHashes == tree.generateProof(5).siblingHashes);
+
+        const std::vector<std::pair<std::size_t, std::string>> updates = {{0, "a"}, {1, "b"}, {150, "c"}, {299, "d"}};
+        tree.updateLeaves(updates);
+        lazyTree.updateLeaves(updates);
+        tree.updateLeaf(200, "e");
+        lazyTree.updateLeaf(200, "e");
+
+        REQUIRE(lazyTree.getRootHash() == tree.getRootHash());
+        for (std::size_t i = 0; i < tree.getTreeSize(); i++) {
+            REQUIRE(lazyTree.generateProof(i).siblingHashes == tree.generateProof(i).siblingHashes);
+        }
+    }
+
+    SECTION("Lazy root updates defer the ancestors of a batch of added hashes") {
+        /**
+         * Growing rehashes the dirty nodes first (see `grow`), so the tree is created large enough.
+         */
+        MerkleTreeOptions options;
+        options.initialHeight = 9;
+        options.lazyRootUpdates = true;
+        MerkleTree<CountingHasher> lazyTree(options);
+        MerkleTree<CountingHasher> eagerTree;
+
+        std::vector<std::string> dataValues;
+        for (int i = 0; i < 300; i++) {
+            dataValues.push_back("data " + std::to_string(i));
+        }
+
+        CountingHasher::nodeHashCount = 0;
+        lazyTree.addHashesOf(std::span(dataValues).first(200));
+        lazyTree.addHashesOf(std::span(dataValues).subspan(200));
+        REQUIRE(CountingHasher::nodeHashCount == 0);
+
+        eagerTree.addHashesOf(dataValues);
+        REQUIRE(lazyTree.getRootHash() == eagerTree.getRootHash());
+        for (std::size_t i = 0; i < eagerTree.getTreeSize(); i++) {
+            REQUIRE(lazyTree.generateProof(i).siblingHashes == eagerTree.generateProof(i).siblingHashes);
+        }
+    }
+
     SECTION("Taking root hash of empty tree throws exception") {
         REQUIRE_THROWS_AS(tree.getRootHash(), MerkleTreeEmptyException);
     }
 
     SECTION("Adding a node updates root hash") {
-        std::array<hash_t, treeCapacity> rootHashes {};
-        for (int i = 1; i <= treeCapacity; i++) {
+        std::array<hash_t, 32> rootHashes {};
+        for (int i = 1; i <= 32; i++) {
             tree.addHashOf("data " + std::to_string(i));
             rootHashes[i-1] = tree.getRootHash();
         }
@@ -34,12 +304,46 @@ TEST_CASE("MerkleTree", "[merkle_tree]") {
         REQUIRE(uniqueRootHashes.size() == rootHashes.size());
     }
 
+    SECTION("Root hash matches a root hash computed from scratch") {
+        std::vector<hash_t> levelHashes(7, 0);
+        for (int i = 0; i < 7; i++) {
+            tree.addHashOf("data " + std::to_string(i));
+            levelHashes[i] = StdHasher::hashLeaf("data " + std::to_string(i));
+        }
+
+        /**
+         * Reduce the leaf level to the root level by hashing sibling pairs, passing a last node without a sibling
+         * up as it is
+         */
+        while (levelHashes.size() > 1) {
+            std::vector<hash_t> parentHashes((levelHashes.size() + 1) / 2);
+            for (std::size_t i = 0; i < parentHashes.size(); i++) {
+                parentHashes[i] = 2 * i + 1 < levelHashes.size()
+                                  ? StdHasher::hashNode(levelHashes[2 * i], levelHashes[2 * i + 1])
+                                  : levelHashes[2 * i];
+            }
+            levelHashes = parentHashes;
+        }
+
+        REQUIRE(tree.getRootHash() == levelHashes[0]);
+    }
+
+    SECTION("Swapping two leaves changes the root hash") {
+        MerkleTree swappedTree;
+        tree.addHashOf("data 0");
+        tree.addHashOf("data 1");
+        swappedTree.addHashOf("data 1");
+        swappedTree.addHashOf("data 0");
+
+        REQUIRE(tree.getRootHash() != swappedTree.getRootHash());
+    }
+
     SECTION("Proof generation for out of range index throws exception") {
-        for (int i = 0; i < treeCapacity; i++) {
+        for (int i = 0; i < 32; i++) {
             tree.addHashOf("data");
         }
 
-        REQUIRE_THROWS_AS(tree.generateProof(treeCapacity), MerkleNodeIndexOutOfRangeException);
+        REQUIRE_THROWS_AS(tree.generateProof(32), MerkleNodeIndexOutOfRangeException);
     }
 
     SECTION("Proof generation for empty tree throws exception") {
@@ -85,7 +389,7 @@ TEST_CASE("MerkleTree", "[merkle_tree]") {
     }
 
     SECTION("Generate and verify proof for each node in a tree with {1, 2, ..., 32} nodes") {
-        for (int numberOfNodes = 1; numberOfNodes <= treeCapacity; numberOfNodes++) {
+        for (int numberOfNodes = 1; numberOfNodes <= 32; numberOfNodes++) {
             tree = MerkleTree();
             std::vector<std::string> dataValues(numberOfNodes);
 
@@ -103,3 +407,362 @@ TEST_CASE("MerkleTree", "[merkle_tree]") {
         }
     }
 }
+
+TEST_CASE("MerkleTree with a custom hash function policy", "[merkle_tree]") {
+    MerkleTree<FnvHasher> tree;
+    std::vector<std::string> dataValues;
+
+    for (int i = 0; i < 50; i++) {
+        dataValues.push_back("data " + std::to_string(i));
+    }
+    tree.addHashesOf(dataValues);
+
+    const FnvHasher::digest_type rootHash = tree.getRootHash();
+
+    for (std::size_t i = 0; i < dataValues.size(); i++) {
+        const MerkleTree<FnvHasher>::proof_t proof = tree.generateProof(i);
+        REQUIRE(verifyProof<FnvHasher>(rootHash, proof, dataValues.at(i)) == true);
+        REQUIRE(verifyProof<FnvHasher>(rootHash, proof, "fake data") == false);
+    }
+}
+
+TEST_CASE("EmptySubtreeHashes", "[merkle_tree]") {
+    SECTION("Every height is the node hash of two empty subtrees one level lower") {
+        REQUIRE(EmptySubtreeHashes<Sha256Hasher>::get(0) == Sha256Digest{});
+
+        for (std::size_t height = 1; height <= EmptySubtreeHashes<Sha256Hasher>::maxHeight; height++) {
+            const Sha256Digest &childHash = EmptySubtreeHashes<Sha256Hasher>::get(height - 1);
+            REQUIRE(EmptySubtreeHashes<Sha256Hasher>::get(height) == Sha256Hasher::hashNode(childHash, childHash));
+        }
+    }
+
+    SECTION("The table is computed once and differs between hash function policies") {
+        REQUIRE(&EmptySubtreeHashes<StdHasher>::get(17) == &EmptySubtreeHashes<StdHasher>::get(17));
+        REQUIRE(EmptySubtreeHashes<FnvHasher>::get(3) != EmptySubtreeHashes<StdHasher>::get(3));
+    }
+}
+
+TEST_CASE("MerkleTree with SHA-256", "[merkle_tree]") {
+    MerkleTree<Sha256Hasher> tree;
+    std::vector<std::string> dataValues;
+
+    for (int i = 0; i < 100; i++) {
+        dataValues.push_back("data " + std::to_string(i));
+        tree.addHashOf(dataValues.back());
+    }
+
+    SECTION("Adding hashes in a batch gives the same root hash as adding them one by one") {
+        MerkleTree<Sha256Hasher> batchTree;
+        batchTree.addHashesOf(dataValues);
+
+        REQUIRE(batchTree.getRootHash() == tree.getRootHash());
+    }
+
+    SECTION("Generate and verify proof for each node") {
+        const Sha256Digest rootHash = tree.getRootHash();
+
+        for (std::size_t i = 0; i < dataValues.size(); i++) {
+            const MerkleTree<Sha256Hasher>::proof_t proof = tree.generateProof(i);
+            REQUIRE(verifyProof<Sha256Hasher>(rootHash, proof, dataValues.at(i)) == true);
+        }
+    }
+
+    SECTION("Root hash follows the hashing scheme of RFC 6962") {
+        MerkleTree<Sha256Hasher> smallTree;
+        smallTree.addHashesOf(std::span(dataValues).first(4));
+
+        std::string hex;
+        for (const std::uint8_t byte : smallTree.getRootHash()) {
+            hex += "0123456789abcdef"[byte >> 4];
+            hex += "0123456789abcdef"[byte & 0xf];
+        }
+        REQUIRE(hex == "69b93e989a2c562b9a060bdf4d10850af42eeef7d387c5589cb76ed644e2c632");
+    }
+
+    SECTION("Root hashes of trees of any size match the test vectors of RFC 6962") {
+        const std::vector<std::string> leaves = {
+            "", std::string(1, '\x00'), "\x10", "\x20\x21", "\x30\x31", "\x40\x41\x42\x43",
+            "\x50\x51\x52\x53\x54\x55\x56\x57", "\x60\x61\x62\x63\x64\x65\x66\x67\x68\x69\x6a\x6b\x6c\x6d\x6e\x6f"};
+        const std::vector<std::string> expectedRootHashes = {
+            "6e340b9cffb37a989ca544e6bb780a2c78901d3fb33738768511a30617afa01d",
+            "fac54203e7cc696cf0dfcb42c92a1d9dbaf70ad9e621f4bd8d98662f00e3c125",
+            "aeb6bcfe274b70a14fb067a5e5578264db0fa9b51af5e0ba159158f329e06e77",
+            "d37ee418976dd95753c1c73862b9398fa2a2cf9b4ff0fdfe8b30cd95209614b7",
+            "4e3bbb1f7b478dcfe71fb631631519a3bca12c9aefca1612bfce4c13a86264d4",
+            "76e67dadbcdf1e10e1b74ddc608abd2f98dfb16fbce75277b5232a127f2087ef",
+            "ddb89be403809e325750d3d263cd78929c2942b7942a34b77e122c9594a74c8c",
+            "5dc9da79a70659a9ad559cb701ded9a2ab9d823aad2f4960cfe370eff4604328"};
+
+        MerkleTree<Sha256Hasher> vectorTree;
+        for (std::size_t i = 0; i < leaves.size(); i++) {
+            vectorTree.addHashOf(leaves[i]);
+
+            std::string hex;
+            for (const std::uint8_t byte : vectorTree.getRootHash()) {
+                hex += "0123456789abcdef"[byte >> 4];
+                hex += "0123456789abcdef"[byte & 0xf];
+            }
+            REQUIRE(hex == expectedRootHashes[i]);
+        }
+    }
+
+    SECTION("Proofs only have hashes for the siblings that exist") {
+        MerkleTree<Sha256Hasher> smallTree;
+        smallTree.addHashesOf(std::span(dataValues).first(5));
+
+        REQUIRE(smallTree.generateProof(0).siblingHashes.size() == 3);
+        REQUIRE(smallTree.generateProof(4).siblingHashes.size() == 1);
+        REQUIRE(smallTree.generateProof(4).siblingHashes[0] == smallTree.getRootHash(4));
+        REQUIRE(verifyProof<Sha256Hasher>(smallTree.getRootHash(), smallTree.generateProof(4), dataValues[4]));
+
+        auto proof = tree.generateProof(99);
+        REQUIRE(proof.siblingHashes.size() == 4);
+        proof.treeSize = 128;
+        REQUIRE(verifyProof<Sha256Hasher>(tree.getRootHash(), proof, dataValues[99]) == false);
+        proof.treeSize = 99;
+        REQUIRE(verifyProof<Sha256Hasher>(tree.getRootHash(), proof, dataValues[99]) == false);
+    }
+
+    SECTION("Verifying proofs in a batch gives the same results as verifying them one by one") {
+        std::vector<MerkleTree<Sha256Hasher>::proof_t> proofs;
+        std::vector<std::string> proofData;
+
+        /**
+         * Valid proofs interleaved with proofs for the wrong data, with swapped siblings and with missing or extra
+         * sibling hashes, more than fit into a single batch
+         */
+        for (std::size_t i = 0; i < 3 * proofBatchSize; i++) {
+            MerkleTree<Sha256Hasher>::proof_t proof = tree.generateProof(i % dataValues.size());
+            std::string data = dataValues.at(i % dataValues.size());
+
+            switch (i % 5) {
+                case 1: data += " (modified)"; break;
+                case 2: proof.leafNodeIndex ^= 1; break;
+                case 3: proof.siblingHashes.pop_back(); break;
+                case 4: proof.siblingHashes.push_back(proof.siblingHashes.front()); break;
+                default: break;
+            }
+
+            proofs.push_back(proof);
+            proofData.push_back(data);
+        }
+
+        const std::vector<bool> results = verifyProofs<Sha256Hasher>(tree.getRootHash(), proofs, proofData);
+
+        REQUIRE(results.size() == proofs.size());
+        for (std::size_t i = 0; i < proofs.size(); i++) {
+            REQUIRE(results[i] == verifyProof<Sha256Hasher>(tree.getRootHash(), proofs[i], proofData[i]));
+            REQUIRE(results[i] == (i % 5 == 0));
+        }
+    }
+
+    SECTION("Verifying a batch with a different number of proofs and data values throws exception") {
+        const std::vector<MerkleTree<Sha256Hasher>::proof_t> proofs = {tree.generateProof(0)};
+
+        REQUIRE_THROWS_AS(verifyProofs<Sha256Hasher>(tree.getRootHash(), proofs, dataValues),
+                          MerkleProofCountMismatchException);
+    }
+
+    SECTION("Proof with swapped siblings is invalid") {
+        MerkleTree<Sha256Hasher>::proof_t proof = tree.generateProof(6);
+        proof.leafNodeIndex = 7;
+
+        REQUIRE(verifyProof<Sha256Hasher>(tree.getRootHash(), proof, "data 6") == false);
+    }
+
+    SECTION("Multiproofs of any set of indexes are valid and smaller than separate proofs") {
+        const std::vector<std::vector<std::size_t>> indexSets = {
+            {0}, {99}, {5, 6}, {6, 5, 5}, {0, 1, 2, 3, 4, 5, 6, 7}, {0, 99}, {3, 17, 18, 40, 64, 65, 98}};
+
+        for (const std::vector<std::size_t> &indexes : indexSets) {
+            const auto proof = tree.generateMultiProof(indexes);
+            const std::set<std::size_t> uniqueIndexes(indexes.begin(), indexes.end());
+            std::vector<std::string> proofData;
+
+            for (const std::size_t i : proof.leafNodeIndexes) {
+                proofData.push_back(dataValues[i]);
+            }
+
+            REQUIRE(std::equal(proof.leafNodeIndexes.begin(), proof.leafNodeIndexes.end(), uniqueIndexes.begin(),
+                               uniqueIndexes.end()));
+            REQUIRE(verifyMultiProof<Sha256Hasher>(tree.getRootHash(), proof, proofData) == true);
+            REQUIRE(proof.siblingHashes.size() <= uniqueIndexes.size() * tree.getTreeHeight());
+        }
+
+        REQUIRE(tree.generateMultiProof(std::vector<std::size_t>{42}).siblingHashes ==
+                tree.generateProof(42).siblingHashes);
+        REQUIRE(tree.generateMultiProof(std::vector<std::size_t>{0, 1, 2, 3, 4, 5, 6, 7}).siblingHashes.size() ==
+                tree.getTreeHeight() - 3);
+    }
+
+    SECTION("Multiproof with wrong data or tampered hashes is invalid") {
+        const auto proof = tree.generateMultiProof(std::vector<std::size_t>{3, 17, 18, 64});
+        const std::vector<std::string> proofData = {dataValues[3], dataValues[17], dataValues[18], dataValues[64]};
+        const std::vector<std::string> wrongData = {dataValues[3], dataValues[18], dataValues[17], dataValues[64]};
+
+        REQUIRE(verifyMultiProof<Sha256Hasher>(tree.getRootHash(), proof, proofData) == true);
+        REQUIRE(verifyMultiProof<Sha256Hasher>(tree.getRootHash(), proof, wrongData) == false);
+
+        for (std::size_t i = 0; i < proof.siblingHashes.size(); i++) {
+            auto tamperedProof = proof;
+            tamperedProof.siblingHashes[i][0] ^= 1;
+            REQUIRE(verifyMultiProof<Sha256Hasher>(tree.getRootHash(), tamperedProof, proofData) == false);
+        }
+
+        auto tamperedProof = proof;
+        tamperedProof.siblingHashes.push_back(proof.siblingHashes.front());
+        REQUIRE(verifyMultiProof<Sha256Hasher>(tree.getRootHash(), tamperedProof, proofData) == false);
+        tamperedProof = proof;
+        tamperedProof.leafNodeIndexes = {3, 18, 17, 64};
+        REQUIRE(verifyMultiProof<Sha256Hasher>(tree.getRootHash(), tamperedProof, wrongData) == false);
+        tamperedProof = proof;
+        tamperedProof.treeSize = 50;
+        REQUIRE(verifyMultiProof<Sha256Hasher>(tree.getRootHash(), tamperedProof, proofData) == false);
+
+        REQUIRE_THROWS_AS(verifyMultiProof<Sha256Hasher>(tree.getRootHash(), proof, dataValues),
+                          MerkleProofCountMismatchException);
+    }
+
+    SECTION("Multiproof generation for an index out of range throws exception") {
+        REQUIRE_THROWS_AS(tree.generateMultiProof(std::vector<std::size_t>{3, 100}), MerkleNodeIndexOutOfRangeException);
+        REQUIRE_THROWS_AS(MerkleTree<Sha256Hasher>().generateMultiProof(std::vector<std::size_t>{0}),
+                          MerkleTreeEmptyException);
+    }
+
+    SECTION("Range proofs of every range are valid") {
+        for (std::size_t first = 0; first < dataValues.size(); first += 7) {
+            for (std::size_t end = first + 1; end <= dataValues.size(); end++) {
+                const auto proof = tree.generateRangeProof(first, end);
+                const std::span<const std::string> rangeData = std::span(dataValues).subspan(first, end - first);
+
+                REQUIRE(verifyRangeProof<Sha256Hasher>(tree.getRootHash(), proof, rangeData) == true);
+                REQUIRE(proof.leftSiblingHashes.size() + proof.rightSiblingHashes.size() <= 2 * tree.getTreeHeight());
+            }
+        }
+
+        REQUIRE(tree.generateRangeProof(0, 100).leftSiblingHashes.empty());
+        REQUIRE(tree.generateRangeProof(64, 65).leftSiblingHashes.size() +
+                tree.generateRangeProof(64, 65).rightSiblingHashes.size() == tree.getTreeHeight());
+    }
+
+    SECTION("Range proof with wrong data or tampered hashes is invalid") {
+        const auto proof = tree.generateRangeProof(13, 42);
+        const std::span<const std::string> rangeData = std::span(dataValues).subspan(13, 29);
+        std::vector<std::string> wrongData(rangeData.begin(), rangeData.end());
+        std::swap(wrongData[3], wrongData[4]);
+
+        REQUIRE(verifyRangeProof<Sha256Hasher>(tree.getRootHash(), proof, rangeData) == true);
+        REQUIRE(verifyRangeProof<Sha256Hasher>(tree.getRootHash(), proof, wrongData) == false);
+
+        for (std::size_t i = 0; i < proof.leftSiblingHashes.size(); i++) {
+            auto tamperedProof = proof;
+            tamperedProof.leftSiblingHashes[i][0] ^= 1;
+            REQUIRE(verifyRangeProof<Sha256Hasher>(tree.getRootHash(), tamperedProof, rangeData) == false);
+        }
+
+        for (std::size_t i = 0; i < proof.rightSiblingHashes.size(); i++) {
+            auto tamperedProof = proof;
+            tamperedProof.rightSiblingHashes[i][0] ^= 1;
+            REQUIRE(verifyRangeProof<Sha256Hasher>(tree.getRootHash(), tamperedProof, rangeData) == false);
+        }
+
+        auto tamperedProof = proof;
+        tamperedProof.firstLeafNodeIndex = 12;
+        REQUIRE(verifyRangeProof<Sha256Hasher>(tree.getRootHash(), tamperedProof, rangeData) == false);
+        tamperedProof = proof;
+        tamperedProof.rightSiblingHashes.pop_back();
+        REQUIRE(verifyRangeProof<Sha256Hasher>(tree.getRootHash(), tamperedProof, rangeData) == false);
+
+        REQUIRE_THROWS_AS(verifyRangeProof<Sha256Hasher>(tree.getRootHash(), proof, dataValues),
+                          MerkleProofCountMismatchException);
+    }
+
+    SECTION("Range proof generation for an empty or out of range range throws exception") {
+        REQUIRE_THROWS_AS(tree.generateRangeProof(5, 5), MerkleNodeIndexOutOfRangeException);
+        REQUIRE_THROWS_AS(tree.generateRangeProof(50, 101), MerkleNodeIndexOutOfRangeException);
+        REQUIRE_THROWS_AS(MerkleTree<Sha256Hasher>().generateRangeProof(0, 1), MerkleTreeEmptyException);
+    }
+
+    SECTION("Root hashes and proofs at past sizes match the ones the tree had at that size") {
+        MerkleTree<Sha256Hasher> growingTree;
+        std::vector<MerkleTree<Sha256Hasher>::hash_t> rootHashes = {{}};
+
+        for (const std::string &data : dataValues) {
+            growingTree.addHashOf(data);
+            rootHashes.push_back(growingTree.getRootHash());
+        }
+
+        for (std::size_t treeSize = 1; treeSize <= dataValues.size(); treeSize++) {
+            REQUIRE(tree.getRootHash(treeSize) == rootHashes[treeSize]);
+
+            for (std::size_t i = 0; i < treeSize; i++) {
+                const auto proof = tree.generateProof(i, treeSize);
+                REQUIRE(verifyProof<Sha256Hasher>(rootHashes[treeSize], proof, dataValues[i]));
+            }
+        }
+
+        REQUIRE(tree.generateProof(37, dataValues.size()).siblingHashes == tree.generateProof(37).siblingHashes);
+    }
+
+    SECTION("Root hashes and proofs at invalid past sizes throw exception") {
+        REQUIRE_THROWS_AS(tree.getRootHash(0), MerkleTreeEmptyException);
+        REQUIRE_THROWS_AS(tree.getRootHash(101), MerkleTreeSizeOutOfRangeException);
+        REQUIRE_THROWS_AS(tree.generateProof(0, 0), MerkleTreeEmptyException);
+        REQUIRE_THROWS_AS(tree.generateProof(0, 101), MerkleTreeSizeOutOfRangeException);
+        REQUIRE_THROWS_AS(tree.generateProof(50, 50), MerkleNodeIndexOutOfRangeException);
+    }
+
+    SECTION("Consistency proofs between all pairs of sizes are valid") {
+        MerkleTree<Sha256Hasher> growingTree;
+        std::vector<MerkleTree<Sha256Hasher>::hash_t> rootHashes = {{}};
+
+        for (int i = 1; i <= 40; i++) {
+            growingTree.addHashOf("data " + std::to_string(i));
+            rootHashes.push_back(growingTree.getRootHash());
+        }
+
+        for (std::size_t newTreeSize = 1; newTreeSize <= 40; newTreeSize++) {
+            for (std::size_t oldTreeSize = 1; oldTreeSize <= newTreeSize; oldTreeSize++) {
+                const auto proof = growingTree.generateConsistencyProof(oldTreeSize, newTreeSize);
+                REQUIRE(verifyConsistency<Sha256Hasher>(rootHashes[oldTreeSize], rootHashes[newTreeSize], proof));
+            }
+        }
+    }
+
+    SECTION("Consistency proof with a wrong root hash or tampered hashes is invalid") {
+        MerkleTree<Sha256Hasher> growingTree;
+        for (int i = 1; i <= 10; i++) {
+            growingTree.addHashOf("data " + std::to_string(i));
+        }
+        const auto oldRootHash = growingTree.getRootHash();
+
+        for (int i = 11; i <= 27; i++) {
+            growingTree.addHashOf("data " + std::to_string(i));
+        }
+        const auto newRootHash = growingTree.getRootHash();
+
+        const auto proof = growingTree.generateConsistencyProof(10, 27);
+        REQUIRE(verifyConsistency<Sha256Hasher>(oldRootHash, newRootHash, proof) == true);
+        REQUIRE(verifyConsistency<Sha256Hasher>(newRootHash, newRootHash, proof) == false);
+        REQUIRE(verifyConsistency<Sha256Hasher>(oldRootHash, oldRootHash, proof) == false);
+
+        for (std::size_t i = 0; i < proof.siblingHashes.size(); i++) {
+            auto tamperedProof = proof;
+            tamperedProof.siblingHashes[i][0] ^= 1;
+            REQUIRE(verifyConsistency<Sha256Hasher>(oldRootHash, newRootHash, tamperedProof) == false);
+        }
+
+        auto tamperedProof = proof;
+        tamperedProof.oldTreeSize = 9;
+        REQUIRE(verifyConsistency<Sha256Hasher>(oldRootHash, newRootHash, tamperedProof) == false);
+        tamperedProof = proof;
+        tamperedProof.siblingHashes.pop_back();
+        REQUIRE(verifyConsistency<Sha256Hasher>(oldRootHash, newRootHash, tamperedProof) == false);
+    }
+
+    SECTION("Consistency proof generation for invalid sizes throws exception") {
+        REQUIRE_THROWS_AS(tree.generateConsistencyProof(0, 5), MerkleTreeSizeOutOfRangeException);
+        REQUIRE_THROWS_AS(tree.generateConsistencyProof(6, 5), MerkleTreeSizeOutOfRangeException);
+        REQUIRE_THROWS_AS(tree.generateConsistencyProof(5, 101), MerkleTreeSizeOutOfRangeException);
+    }
+}
@@ -0,0 +1,458 @@
+#include <cstring>
+#include "sha256.hpp"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SHA256_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+
+/**
+ * The functions of FIPS 180-4, section 4.1.2. These are macros rather than functions so that the same expressions work
+ * both on single 32-bit words and on vectors of words (see `compressBlock`) without passing vectors around by value.
+ */
+#define SHA256_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define SHA256_CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define SHA256_MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define SHA256_BSIG0(x) (SHA256_ROTR(x, 2) ^ SHA256_ROTR(x, 13) ^ SHA256_ROTR(x, 22))
+#define SHA256_BSIG1(x) (SHA256_ROTR(x, 6) ^ SHA256_ROTR(x, 11) ^ SHA256_ROTR(x, 25))
+#define SHA256_SSIG0(x) (SHA256_ROTR(x, 7) ^ SHA256_ROTR(x, 18) ^ ((x) >> 3))
+#define SHA256_SSIG1(x) (SHA256_ROTR(x, 17) ^ SHA256_ROTR(x, 19) ^ ((x) >> 10))
+
+namespace {
+
+constexpr std::size_t blockSize = 64;
+
+alignas(16) constexpr std::array<std::uint32_t, 64> roundConstants = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+constexpr std::array<std::uint32_t, 8> initialState = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+/**
+ * The message of a node hash is a prefix byte followed by two digests, 65 bytes in total. Together with the padding
+ * (a 1 bit, zeros and the message length of 520 bits as a 64-bit big-endian number) it takes exactly two blocks, i.e.
+ * twice the compressions of the two digests alone. That is the cost of the RFC 6962 prefix, which is kept so that the
+ * hashes stay plain SHA-256 (see the README).
+ */
+constexpr std::size_t pairMessageSize = 1 + 2 * sizeof(Sha256Digest);
+constexpr std::uint32_t pairMessageBitLength = 8 * pairMessageSize;
+
+[[nodiscard]] std::uint32_t loadBigEndian(const std::uint8_t *bytes) noexcept {
+    return static_cast<std::uint32_t>(bytes[0]) << 24 | static_cast<std::uint32_t>(bytes[1]) << 16 |
+           static_cast<std::uint32_t>(bytes[2]) << 8 | static_cast<std::uint32_t>(bytes[3]);
+}
+
+void storeBigEndian(const std::uint32_t word, std::uint8_t *bytes) noexcept {
+    bytes[0] = static_cast<std::uint8_t>(word >> 24);
+    bytes[1] = static_cast<std::uint8_t>(word >> 16);
+    bytes[2] = static_cast<std::uint8_t>(word >> 8);
+    bytes[3] = static_cast<std::uint8_t>(word);
+}
+
+/**
+ * Fill in words 16..63 of a message schedule whose first 16 words are the words of the message block.
+ */
+template<typename Word>
+[[gnu::always_inline]] inline void expandSchedule(Word *schedule) noexcept {
+    for (std::size_t t = 16; t < 64; t++) {
+        schedule[t] = SHA256_SSIG1(schedule[t - 2]) + schedule[t - 7] + SHA256_SSIG0(schedule[t - 15]) + schedule[t - 16];
+    }
+}
+
+/**
+ * Run the 64 rounds of the compression function on the given state with the given (expanded) message schedule.
+ *
+ * `Word` is either std::uint32_t or a GCC vector of them, in which case every lane of the vector holds the state and
+ * the schedule of a different, independent message. This function is always inlined, so that it gets compiled with the
+ * instruction set of the kernel that calls it.
+ */
+template<typename Word>
+[[gnu::always_inline]] inline void compressBlock(Word *state, const Word *schedule) noexcept {
+    Word a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (std::size_t t = 0; t < 64; t++) {
+        const Word temp1 = h + SHA256_BSIG1(e) + SHA256_CH(e, f, g) + roundConstants[t] + schedule[t];
+        const Word temp2 = SHA256_BSIG0(a) + SHA256_MAJ(a, b, c);
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+void compressBlocksScalar(std::uint32_t *state, const std::uint8_t *blocks, const std::size_t blockCount) noexcept {
+    for (std::size_t block = 0; block < blockCount; block++) {
+        std::array<std::uint32_t, 64> schedule;
+        for (std::size_t t = 0; t < 16; t++) {
+            schedule[t] = loadBigEndian(&blocks[block * blockSize + 4 * t]);
+        }
+
+        expandSchedule(schedule.data());
+        compressBlock(state, schedule.data());
+    }
+}
+
+/**
+ * Write the two padded blocks of the message prefix || pair[0] || pair[1] into `blocks`, which must be zeroed.
+ */
+void fillPairBlocks(const std::uint8_t prefix, const Sha256Digest *pair, std::uint8_t *blocks) noexcept {
+    blocks[0] = prefix;
+    std::memcpy(&blocks[1], pair->data(), 2 * sizeof(Sha256Digest));
+    blocks[pairMessageSize] = 0x80;
+    storeBigEndian(pairMessageBitLength, &blocks[2 * blockSize - 4]);
+}
+
+/**
+ * Hash the pairs one at a time, compressing their blocks with the given single-message function.
+ */
+template<void (*CompressBlocks)(std::uint32_t *, const std::uint8_t *, std::size_t) noexcept>
+void hashPairsOneByOne(const std::uint8_t prefix, const Sha256Digest *children, Sha256Digest *parents,
+                       const std::size_t count) noexcept {
+    for (std::size_t i = 0; i < count; i++) {
+        std::array<std::uint8_t, 2 * blockSize> blocks = {};
+        fillPairBlocks(prefix, &children[2 * i], blocks.data());
+
+        std::array<std::uint32_t, 8> state = initialState;
+        CompressBlocks(state.data(), blocks.data(), 2);
+
+        for (std::size_t word = 0; word < state.size(); word++) {
+            storeBigEndian(state[word], &parents[i][4 * word]);
+        }
+    }
+}
+
+void hashPairsScalar(const std::uint8_t prefix, const Sha256Digest *children, Sha256Digest *parents,
+                     const std::size_t count) noexcept {
+    hashPairsOneByOne<compressBlocksScalar>(prefix, children, parents, count);
+}
+
+/**
+ * Compress whole blocks with the fastest single-message kernel available (defined below).
+ */
+void compressBlocks(std::uint32_t *state, const std::uint8_t *blocks, std::size_t blockCount) noexcept;
+
+#ifdef SHA256_X86_KERNELS
+
+using Lanes4 = std::uint32_t __attribute__((vector_size(16)));
+using Lanes8 = std::uint32_t __attribute__((vector_size(32)));
+using Lanes16 = std::uint32_t __attribute__((vector_size(64)));
+
+/**
+ * Hash the pairs `Lanes` at a time, one pair per lane of `Vector`. Loading the message words transposes them: word t of
+ * pair i goes into lane i of schedule[t]. The pairs that are left over once there are fewer than `Lanes` of them
+ * (including a single pair, as hashed by Sha256Hasher::hashNode) are hashed one by one with the fastest single-message
+ * kernel.
+ *
+ * Because of the prefix byte, the words of the first block are the bytes of the pair shifted by one. The second block
+ * only has one word that depends on the pair (the last byte of the pair followed by the 1 bit of the padding), the rest
+ * of it is zeros and the message length.
+ */
+template<typename Vector, std::size_t Lanes>
+[[gnu::always_inline]] inline void hashPairsInLanes(const std::uint8_t prefix, const Sha256Digest *children,
+                                                    Sha256Digest *parents, const std::size_t count) noexcept {
+    std::size_t first = 0;
+
+    for (; first + Lanes <= count; first += Lanes) {
+        Vector schedule[64];
+        Vector state[8];
+
+        for (std::size_t lane = 0; lane < Lanes; lane++) {
+            const std::uint8_t *pair = children[2 * (first + lane)].data();
+
+            schedule[0][lane] = static_cast<std::uint32_t>(prefix) << 24 | static_cast<std::uint32_t>(pair[0]) << 16 |
+                                static_cast<std::uint32_t>(pair[1]) << 8 | static_cast<std::uint32_t>(pair[2]);
+            for (std::size_t t = 1; t < 16; t++) {
+                schedule[t][lane] = loadBigEndian(pair + 4 * t - 1);
+            }
+        }
+
+        for (std::size_t word = 0; word < 8; word++) {
+            state[word] = Vector{} + initialState[word];
+        }
+
+        expandSchedule(schedule);
+        compressBlock(state, schedule);
+
+        for (std::size_t lane = 0; lane < Lanes; lane++) {
+            const std::uint8_t *pair = children[2 * (first + lane)].data();
+            schedule[0][lane] = static_cast<std::uint32_t>(pair[2 * sizeof(Sha256Digest) - 1]) << 24 | 0x80u << 16;
+        }
+        for (std::size_t t = 1; t < 15; t++) {
+            schedule[t] = Vector{};
+        }
+        schedule[15] = Vector{} + pairMessageBitLength;
+
+        expandSchedule(schedule);
+        compressBlock(state, schedule);
+
+        for (std::size_t lane = 0; lane < Lanes; lane++) {
+            for (std::size_t word = 0; word < 8; word++) {
+                storeBigEndian(state[word][lane], &parents[first + lane][4 * word]);
+            }
+        }
+    }
+
+    hashPairsOneByOne<compressBlocks>(prefix, children + 2 * first, parents + first, count - first);
+}
+
+[[gnu::target("sse4.1")]]
+void hashPairsSse41(const std::uint8_t prefix, const Sha256Digest *children, Sha256Digest *parents,
+                    const std::size_t count) noexcept {
+    hashPairsInLanes<Lanes4, 4>(prefix, children, parents, count);
+}
+
+[[gnu::target("avx2")]]
+void hashPairsAvx2(const std::uint8_t prefix, const Sha256Digest *children, Sha256Digest *parents,
+                   const std::size_t count) noexcept {
+    hashPairsInLanes<Lanes8, 8>(prefix, children, parents, count);
+}
+
+[[gnu::target("avx512f")]]
+void hashPairsAvx512(const std::uint8_t prefix, const Sha256Digest *children, Sha256Digest *parents,
+                     const std::size_t count) noexcept {
+    hashPairsInLanes<Lanes16, 16>(prefix, children, parents, count);
+}
+
+/**
+ * The compression function using the SHA extensions. The instructions keep the state in two registers in the order
+ * ABEF and CDGH rather than ABCD and EFGH, and each sha256rnds2 instruction does two rounds, so four rounds are done per
+ * 4-word group of the message schedule. The schedule itself is computed on the fly, one group at a time, with
+ * sha256msg1 and sha256msg2.
+ */
+[[gnu::target("sha,sse4.1")]]
+void compressBlocksShaNi(std::uint32_t *state, const std::uint8_t *blocks, const std::size_t blockCount) noexcept {
+    const __m128i byteSwapMask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i temp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[0])), 0xB1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&state[4])), 0x1B);
+    __m128i state0 = _mm_alignr_epi8(temp, state1, 8);
+    state1 = _mm_blend_epi16(state1, temp, 0xF0);
+
+    for (std::size_t block = 0; block < blockCount; block++) {
+        const __m128i savedState0 = state0;
+        const __m128i savedState1 = state1;
+        __m128i groups[4];
+
+#pragma GCC unroll 16
+        for (std::size_t group = 0; group < 16; group++) {
+            __m128i words;
+
+            if (group < 4) {
+                words = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&blocks[block * blockSize + 16 * group]));
+                words = _mm_shuffle_epi8(words, byteSwapMask);
+            } else {
+                const __m128i &minus4 = groups[group % 4];
+                const __m128i &minus3 = groups[(group + 1) % 4];
+                const __m128i &minus2 = groups[(group + 2) % 4];
+                const __m128i &minus1 = groups[(group + 3) % 4];
+
+                words = _mm_sha256msg1_epu32(minus4, minus3);
+                words = _mm_add_epi32(words, _mm_alignr_epi8(minus1, minus2, 4));
+                words = _mm_sha256msg2_epu32(words, minus1);
+            }
+
+            groups[group % 4] = words;
+
+            __m128i roundInput = _mm_add_epi32(
+                    words, _mm_load_si128(reinterpret_cast<const __m128i *>(&roundConstants[4 * group])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, roundInput);
+            roundInput = _mm_shuffle_epi32(roundInput, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, roundInput);
+        }
+
+        state0 = _mm_add_epi32(state0, savedState0);
+        state1 = _mm_add_epi32(state1, savedState1);
+    }
+
+    temp = _mm_shuffle_epi32(state0, 0x1B);
+    state1 = _mm_shuffle_epi32(state1, 0xB1);
+    state0 = _mm_blend_epi16(temp, state1, 0xF0);
+    state1 = _mm_alignr_epi8(state1, temp, 8);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&state[4]), state1);
+}
+
+void hashPairsShaNi(const std::uint8_t prefix, const Sha256Digest *children, Sha256Digest *parents,
+                    const std::size_t count) noexcept {
+    hashPairsOneByOne<compressBlocksShaNi>(prefix, children, parents, count);
+}
+
+#endif
+
+void compressBlocks(std::uint32_t *state, const std::uint8_t *blocks, const std::size_t blockCount) noexcept {
+#ifdef SHA256_X86_KERNELS
+    static const bool useShaNi = isSha256KernelSupported(Sha256Kernel::shaNi);
+    if (useShaNi) {
+        compressBlocksShaNi(state, blocks, blockCount);
+        return;
+    }
+#endif
+
+    compressBlocksScalar(state, blocks, blockCount);
+}
+
+/**
+ * Pad and compress the last bytes of a message (fewer than a block) and return the digest.
+ *
+ * The remaining bytes are followed by a 1 bit, zeros and the length of the whole message in bits as a 64-bit big-endian
+ * number. If the length does not fit into the block with the remaining bytes, it goes into an extra block.
+ */
+Sha256Digest finish(std::uint32_t *state, const std::uint8_t *remainingBytes, const std::size_t remainingByteCount,
+                    const std::size_t messageSize) noexcept {
+    std::array<std::uint8_t, 2 * blockSize> lastBlocks = {};
+    if (remainingByteCount > 0) {
+        std::memcpy(lastBlocks.data(), remainingBytes, remainingByteCount);
+    }
+    lastBlocks[remainingByteCount] = 0x80;
+
+    const std::size_t lastBlockCount = remainingByteCount + 1 + 8 <= blockSize ? 1 : 2;
+    const std::uint64_t bitLength = static_cast<std::uint64_t>(messageSize) * 8;
+    for (std::size_t i = 0; i < 8; i++) {
+        lastBlocks[lastBlockCount * blockSize - 1 - i] = static_cast<std::uint8_t>(bitLength >> (8 * i));
+    }
+
+    compressBlocks(state, lastBlocks.data(), lastBlockCount);
+
+    Sha256Digest digest;
+    for (std::size_t word = 0; word < 8; word++) {
+        storeBigEndian(state[word], &digest[4 * word]);
+    }
+
+    return digest;
+}
+
+}
+
+bool isSha256KernelSupported(const Sha256Kernel kernel) noexcept {
+#ifdef SHA256_X86_KERNELS
+    __builtin_cpu_init();
+
+    switch (kernel) {
+        case Sha256Kernel::scalar:
+            return true;
+        case Sha256Kernel::sse41:
+            return __builtin_cpu_supports("sse4.1");
+        case Sha256Kernel::avx2:
+            return __builtin_cpu_supports("avx2");
+        case Sha256Kernel::avx512:
+            return __builtin_cpu_supports("avx512f");
+        case Sha256Kernel::shaNi:
+            return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+    }
+
+    return false;
+#else
+    return kernel == Sha256Kernel::scalar;
+#endif
+}
+
+Sha256Kernel getBestSha256Kernel() noexcept {
+    /**
+     * Hashing 16 pairs at once with AVX-512 beats the SHA extensions, which hash one pair at a time and are bound by
+     * the latency of the sha256rnds2 instruction. The SHA extensions in turn beat the narrower vectors.
+     */
+    static const Sha256Kernel bestKernel = [] {
+        for (const Sha256Kernel kernel : {Sha256Kernel::avx512, Sha256Kernel::shaNi, Sha256Kernel::avx2, Sha256Kernel::sse41}) {
+            if (isSha256KernelSupported(kernel)) {
+                return kernel;
+            }
+        }
+
+        return Sha256Kernel::scalar;
+    }();
+
+    return bestKernel;
+}
+
+Sha256Digest sha256(const std::string_view data) noexcept {
+    std::array<std::uint32_t, 8> state = initialState;
+    const auto *bytes = reinterpret_cast<const std::uint8_t *>(data.data());
+
+    const std::size_t wholeBlockCount = data.size() / blockSize;
+    compressBlocks(state.data(), bytes, wholeBlockCount);
+
+    const std::size_t remainingByteCount = data.size() - wholeBlockCount * blockSize;
+    return finish(state.data(), bytes + wholeBlockCount * blockSize, remainingByteCount, data.size());
+}
+
+Sha256Digest sha256(const std::uint8_t prefix, const std::string_view data) noexcept {
+    std::array<std::uint32_t, 8> state = initialState;
+    const auto *bytes = reinterpret_cast<const std::uint8_t *>(data.data());
+
+    /**
+     * The first block is the prefix and the first 63 bytes of the data, after that the data is compressed in place
+     * (shifted by one byte compared to `sha256(data)`).
+     */
+    if (data.size() < blockSize - 1) {
+        std::array<std::uint8_t, blockSize> firstBytes = {prefix};
+        if (!data.empty()) {
+            std::memcpy(&firstBytes[1], bytes, data.size());
+        }
+        return finish(state.data(), firstBytes.data(), data.size() + 1, data.size() + 1);
+    }
+
+    std::array<std::uint8_t, blockSize> firstBlock = {prefix};
+    std::memcpy(&firstBlock[1], bytes, blockSize - 1);
+    compressBlocks(state.data(), firstBlock.data(), 1);
+
+    const std::string_view rest = data.substr(blockSize - 1);
+    const auto *restBytes = reinterpret_cast<const std::uint8_t *>(rest.data());
+    const std::size_t wholeBlockCount = rest.size() / blockSize;
+    compressBlocks(state.data(), restBytes, wholeBlockCount);
+
+    const std::size_t remainingByteCount = rest.size() - wholeBlockCount * blockSize;
+    return finish(state.data(), restBytes + wholeBlockCount * blockSize, remainingByteCount, data.size() + 1);
+}
+
+void sha256Pairs(const std::uint8_t prefix, const std::span<const Sha256Digest> children,
+                 const std::span<Sha256Digest> parents) noexcept {
+    sha256Pairs(prefix, children, parents, getBestSha256Kernel());
+}
+
+void sha256Pairs(const std::uint8_t prefix, const std::span<const Sha256Digest> children,
+                 const std::span<Sha256Digest> parents, const Sha256Kernel kernel) noexcept {
+    switch (kernel) {
+#ifdef SHA256_X86_KERNELS
+        case Sha256Kernel::sse41:
+            hashPairsSse41(prefix, children.data(), parents.data(), parents.size());
+            return;
+        case Sha256Kernel::avx2:
+            hashPairsAvx2(prefix, children.data(), parents.data(), parents.size());
+            return;
+        case Sha256Kernel::avx512:
+            hashPairsAvx512(prefix, children.data(), parents.data(), parents.size());
+            return;
+        case Sha256Kernel::shaNi:
+            hashPairsShaNi(prefix, children.data(), parents.data(), parents.size());
+            return;
+#endif
+        default:
+            hashPairsScalar(prefix, children.data(), parents.data(), parents.size());
+            return;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+
+/**
+ * A SHA-256 digest: 32 bytes, in the byte order defined by the standard (FIPS 180-4).
+ */
+using Sha256Digest = std::array<std::uint8_t, 32>;
+
+/**
+ * Implementations of the SHA-256 compression function. All of them produce the same digests, they only differ in which
+ * instructions they use and in how many independent messages they process at a time.
+ */
+enum class Sha256Kernel {
+    /**
+     * Plain C++, one message at a time. Always supported.
+     */
+    scalar,
+
+    /**
+     * 4 messages at a time, one per 32-bit lane of a 128-bit SSE register.
+     */
+    sse41,
+
+    /**
+     * 8 messages at a time, one per 32-bit lane of a 256-bit AVX2 register.
+     */
+    avx2,
+
+    /**
+     * 16 messages at a time, one per 32-bit lane of a 512-bit AVX-512 register.
+     */
+    avx512,
+
+    /**
+     * One message at a time using the dedicated SHA-256 instructions (Intel SHA extensions).
+     */
+    shaNi,
+};
+
+/**
+ * @return true if the CPU that the program is running on supports the instructions used by the given kernel.
+ */
+[[nodiscard]] bool isSha256KernelSupported(Sha256Kernel kernel) noexcept;
+
+/**
+ * @return the kernel that hashes pairs (see `sha256Pairs`) the fastest on the CPU that the program is running on,
+ * determined once, using CPUID. Single messages (see `sha256`) always use the SHA extensions if they are supported.
+ */
+[[nodiscard]] Sha256Kernel getBestSha256Kernel() noexcept;
+
+/**
+ * @return the SHA-256 digest of the given data.
+ */
+[[nodiscard]] Sha256Digest sha256(std::string_view data) noexcept;
+
+/**
+ * @return the SHA-256 digest of the given prefix byte followed by the given data, computed without copying the data.
+ */
+[[nodiscard]] Sha256Digest sha256(std::uint8_t prefix, std::string_view data) noexcept;
+
+/**
+ * Hash pairs of digests: parents[i] = SHA-256(prefix || children[2 * i] || children[2 * i + 1]) for every i. This is
+ * the operation used for building a level of a Merkle tree from the level below it. The messages have a fixed size
+ * of 65 bytes (two blocks), so they are laid out directly on the stack, and they are independent of each other, so the
+ * multi-buffer kernels hash several of them at once.
+ *
+ * `children` must contain exactly twice as many digests as `parents`. The first overload uses getBestSha256Kernel(),
+ * the second one uses the given kernel, which must be supported by the CPU.
+ */
+void sha256Pairs(std::uint8_t prefix, std::span<const Sha256Digest> children, std::span<Sha256Digest> parents) noexcept;
+void sha256Pairs(std::uint8_t prefix, std::span<const Sha256Digest> children, std::span<Sha256Digest> parents,
+                 Sha256Kernel kernel) noexcept;
@@ -0,0 +1,70 @@
+#include <string>
+#include <vector>
+#include "catch2/catch_test_macros.hpp"
+#include "sha256.hpp"
+
+
+/**
+ * @return the digest as a lowercase hexadecimal string, the format used by the test vectors
+ */
+static std::string toHex(const Sha256Digest &digest) {
+    static constexpr char hexDigits[] = "0123456789abcdef";
+    std::string hex;
+
+    for (const std::uint8_t byte : digest) {
+        hex += hexDigits[byte >> 4];
+        hex += hexDigits[byte & 0x0f];
+    }
+
+    return hex;
+}
+
+TEST_CASE("SHA-256", "[sha256]") {
+    SECTION("Digests match the FIPS 180-4 test vectors") {
+        REQUIRE(toHex(sha256("")) == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        REQUIRE(toHex(sha256("abc")) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        REQUIRE(toHex(sha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")) ==
+                "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+        REQUIRE(toHex(sha256(std::string(1000000, 'a'))) ==
+                "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+
+    SECTION("Messages whose padding does or does not fit into the last block") {
+        REQUIRE(toHex(sha256(std::string(55, 'a'))) == "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318");
+        REQUIRE(toHex(sha256(std::string(56, 'a'))) == "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a");
+        REQUIRE(toHex(sha256(std::string(64, 'a'))) == "ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb");
+    }
+
+    SECTION("Hashing with a prefix byte is the same as hashing the prefixed message") {
+        for (const std::size_t size : {0, 1, 54, 55, 62, 63, 64, 127, 128, 1000}) {
+            const std::string data(size, 'a');
+            REQUIRE(sha256(0x00, data) == sha256('\x00' + data));
+            REQUIRE(sha256(0x01, data) == sha256('\x01' + data));
+        }
+    }
+
+    SECTION("Every supported kernel hashes pairs the same as hashing the prefixed concatenation") {
+        std::vector<Sha256Digest> children;
+        for (int i = 0; i < 2 * 37; i++) {
+            children.push_back(sha256("child " + std::to_string(i)));
+        }
+
+        std::vector<Sha256Digest> expectedParents;
+        for (std::size_t i = 0; i < children.size() / 2; i++) {
+            const std::string message = '\x01' + std::string(reinterpret_cast<const char *>(children[2 * i].data()),
+                                                              2 * sizeof(Sha256Digest));
+            expectedParents.push_back(sha256(message));
+        }
+
+        for (const Sha256Kernel kernel : {Sha256Kernel::scalar, Sha256Kernel::sse41, Sha256Kernel::avx2,
+                                          Sha256Kernel::avx512, Sha256Kernel::shaNi}) {
+            if (!isSha256KernelSupported(kernel)) {
+                continue;
+            }
+
+            std::vector<Sha256Digest> parents(children.size() / 2);
+            sha256Pairs(0x01, children, parents, kernel);
+            REQUIRE(parents == expectedParents);
+        }
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "merkle_tree.hpp"
+
+
+/**
+ * A key of a SortedMerkleTree along with the proof of its leaf node.
+ */
+template<typename Digest>
+struct MerkleNeighbourProof {
+    std::string key;
+
+    MerkleProof<Digest> proof;
+};
+
+/**
+ * A proof that a key is not in a SortedMerkleTree, generated by `SortedMerkleTree::generateAbsenceProof` and checked
+ * with `verifyAbsence`: the proofs of the two adjacent leaves whose keys bracket the missing key. If the key is smaller
+ * (greater) than every key in the tree, there is no lower (upper) neighbour, and the upper (lower) neighbour has to be
+ * the first (last) leaf instead.
+ */
+template<typename Digest>
+struct MerkleAbsenceProof {
+    std::optional<MerkleNeighbourProof<Digest>> lowerNeighbour;
+
+    std::optional<MerkleNeighbourProof<Digest>> upperNeighbour;
+};
+
+/**
+ * A MerkleTree whose leaves are the hashes of keys kept in sorted order (byte-wise, as std::string compares them)
+ * without duplicates, so that besides the presence of a key, the tree can also prove its absence: two adjacent leaves
+ * whose keys bracket a key leave no place for it. Both are found with a binary search over the keys, so generating and
+ * verifying proofs takes O(log n) time.
+ *
+ * Unlike MerkleTree, the tree keeps the keys themselves (the proofs of absence need the neighbouring keys). Inserting a
+ * key that is greater than all the others appends a leaf like `MerkleTree::addHashOf`, inserting it anywhere else
+ * shifts every following leaf by one and rehashes them with `MerkleTree::updateLeaves`, so keys should preferably be
+ * inserted in batches or in ascending order. Keys cannot be removed.
+ */
+template<MerkleHasher Hasher = StdHasher>
+struct SortedMerkleTree {
+
+public:
+
+    using hash_t = typename Hasher::digest_type;
+    using proof_t = MerkleProof<hash_t>;
+    using absence_proof_t = MerkleAbsenceProof<hash_t>;
+
+private:
+
+    std::vector<std::string> keys;
+
+    MerkleTree<Hasher> tree;
+
+    /**
+     * Replace the leaves in [firstLeafNodeIndex, endLeafNodeIndex) with the hashes of the keys now at their indexes.
+     */
+    void updateLeavesFrom(std::size_t firstLeafNodeIndex, std::size_t endLeafNodeIndex);
+
+    [[nodiscard]] MerkleNeighbourProof<hash_t> generateNeighbourProof(std::size_t leafNodeIndex) const;
+
+public:
+
+    /**
+     * The tree is empty upon creation. The options are passed on to the underlying MerkleTree.
+     *
+     * @throws MerkleTreeHeightOutOfRangeException if the heights in the options are out of range
+     */
+    explicit SortedMerkleTree(const MerkleTreeOptions &options = {}) : tree(options) {}
+
+    /**
+     * Insert a key at its place in the sorted order.
+     *
+     * @return true if the key was inserted, false if it was already in the tree
+     * @throws MerkleTreeFullException if the tree is full and already at its maximum height (the tree is not modified)
+     */
+    bool insert(std::string_view key);
+
+    /**
+     * Insert all the given keys at once: the keys are merged into the sorted keys of the tree, the leaves from the
+     * first changed one on are replaced in a single `MerkleTree::updateLeaves` call and the remaining ones are added
+     * with `MerkleTree::addHashesOf`.
+     *
+     * @return the number of keys that were not in the tree yet
+     * @throws MerkleTreeFullException if the keys do not fit into a tree of the maximum height (the tree is not modified)
+     */
+    std::size_t insert(std::span<const std::string> newKeys);
+
+    /**
+     * @return the index of the leaf node of the key, or std::nullopt if the key is not in the tree
+     */
+    [[nodiscard]] std::optional<std::size_t> find(std::string_view key) const;
+
+    [[nodiscard]] bool contains(const std::string_view key) const {
+        return find(key).has_value();
+    }
+
+    /**
+     * @throws MerkleTreeEmptyException if the tree is empty
+     */
+    [[nodiscard]] hash_t getRootHash() const {
+        return tree.getRootHash();
+    }
+
+    [[nodiscard]] std::size_t getTreeSize() const noexcept {
+        return tree.getTreeSize();
+    }
+
+    /**
+     * Generate a proof that the key is in the tree, to be used in `verifyProof` with the key as the data.
+     *
+     * @throws MerkleKeyNotFoundException if the key is not in the tree
+     */
+    [[nodiscard]] proof_t generateProof(std::string_view key) const;
+
+    /**
+     * Generate a proof that the key is not in the tree, to be used in `verifyAbsence`.
+     *
+     * @throws MerkleTreeEmptyException if the tree is empty (there is no root hash to verify the proof against)
+     * @throws MerkleKeyFoundException if the key is in the tree
+     */
+    [[nodiscard]] absence_proof_t generateAbsenceProof(std::string_view key) const;
+};
+
+/**
+ * Verify whether the key was absent from the sorted tree with the given root hash. `Hasher` has to be the same hash
+ * function policy that the tree was created with.
+ * @param rootHash the hash of the root node of the tree
+ * @param key the key whose absence from the tree is to be verified
+ * @param proof the proof generated by `generateAbsenceProof`
+ * @return true if the neighbours in the proof are adjacent leaves of the tree (or the first or last leaf) and their
+ * keys bracket the given key, false otherwise
+ */
+template<MerkleHasher Hasher = StdHasher>
+[[nodiscard]] bool verifyAbsence(const typename Hasher::digest_type &rootHash, std::string_view key,
+                                 const MerkleAbsenceProof<typename Hasher::digest_type> &proof) noexcept;
+
+
+#include "sorted_merkle_tree.tpp"
@@ -0,0 +1,145 @@
+#pragma once
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include "merkle_tree_exceptions.hpp"
+
+
+template<MerkleHasher Hasher>
+void SortedMerkleTree<Hasher>::updateLeavesFrom(const std::size_t firstLeafNodeIndex,
+                                                const std::size_t endLeafNodeIndex) {
+    if (firstLeafNodeIndex >= endLeafNodeIndex) {
+        return;
+    }
+
+    std::vector<std::pair<std::size_t, std::string>> updates;
+    updates.reserve(endLeafNodeIndex - firstLeafNodeIndex);
+    for (std::size_t i = firstLeafNodeIndex; i < endLeafNodeIndex; i++) {
+        updates.emplace_back(i, keys[i]);
+    }
+
+    tree.updateLeaves(updates);
+}
+
+template<MerkleHasher Hasher>
+MerkleNeighbourProof<typename SortedMerkleTree<Hasher>::hash_t> SortedMerkleTree<Hasher>::generateNeighbourProof(
+        const std::size_t leafNodeIndex) const {
+    return {keys[leafNodeIndex], tree.generateProof(leafNodeIndex)};
+}
+
+template<MerkleHasher Hasher>
+bool SortedMerkleTree<Hasher>::insert(const std::string_view key) {
+    const auto position = std::lower_bound(keys.begin(), keys.end(), key);
+    if (position != keys.end() && *position == key) {
+        return false;
+    }
+
+    /**
+     * The tree grows by one leaf at the end, which either gets the new key or the current last key, so it is added
+     * first: if the tree is full, nothing has been changed yet.
+     */
+    const std::size_t leafNodeIndex = position - keys.begin();
+    const std::size_t oldTreeSize = keys.size();
+    tree.addHashOf(position == keys.end() ? key : std::string_view(keys.back()));
+
+    keys.emplace(position, key);
+    updateLeavesFrom(leafNodeIndex, oldTreeSize);
+    return true;
+}
+
+template<MerkleHasher Hasher>
+std::size_t SortedMerkleTree<Hasher>::insert(const std::span<const std::string> newKeys) {
+    std::vector<std::string> sortedNewKeys(newKeys.begin(), newKeys.end());
+    std::sort(sortedNewKeys.begin(), sortedNewKeys.end());
+
+    std::vector<std::string> mergedKeys;
+    mergedKeys.reserve(keys.size() + sortedNewKeys.size());
+    std::set_union(keys.begin(), keys.end(), sortedNewKeys.begin(), sortedNewKeys.end(),
+                   std::back_inserter(mergedKeys));
+    mergedKeys.erase(std::unique(mergedKeys.begin(), mergedKeys.end()), mergedKeys.end());
+
+    const std::size_t oldTreeSize = keys.size();
+    const std::size_t firstChangedIndex = std::mismatch(keys.begin(), keys.end(), mergedKeys.begin()).first
+                                          - keys.begin();
+
+    tree.addHashesOf(mergedKeys.begin() + static_cast<std::ptrdiff_t>(oldTreeSize), mergedKeys.end());
+
+    keys = std::move(mergedKeys);
+    updateLeavesFrom(firstChangedIndex, oldTreeSize);
+    return keys.size() - oldTreeSize;
+}
+
+template<MerkleHasher Hasher>
+std::optional<std::size_t> SortedMerkleTree<Hasher>::find(const std::string_view key) const {
+    const auto position = std::lower_bound(keys.begin(), keys.end(), key);
+    if (position == keys.end() || *position != key) {
+        return std::nullopt;
+    }
+
+    return position - keys.begin();
+}
+
+template<MerkleHasher Hasher>
+typename SortedMerkleTree<Hasher>::proof_t SortedMerkleTree<Hasher>::generateProof(const std::string_view key) const {
+    const std::optional<std::size_t> leafNodeIndex = find(key);
+    if (!leafNodeIndex) {
+        throw MerkleKeyNotFoundException();
+    }
+
+    return tree.generateProof(*leafNodeIndex);
+}
+
+template<MerkleHasher Hasher>
+typename SortedMerkleTree<Hasher>::absence_proof_t SortedMerkleTree<Hasher>::generateAbsenceProof(
+        const std::string_view key) const {
+    if (keys.empty()) {
+        throw MerkleTreeEmptyException();
+    }
+
+    const auto position = std::lower_bound(keys.begin(), keys.end(), key);
+    if (position != keys.end() && *position == key) {
+        throw MerkleKeyFoundException();
+    }
+
+    const std::size_t upperLeafNodeIndex = position - keys.begin();
+
+    absence_proof_t proof;
+    if (upperLeafNodeIndex > 0) {
+        proof.lowerNeighbour = generateNeighbourProof(upperLeafNodeIndex - 1);
+    }
+    if (upperLeafNodeIndex < keys.size()) {
+        proof.upperNeighbour = generateNeighbourProof(upperLeafNodeIndex);
+    }
+
+    return proof;
+}
+
+template<MerkleHasher Hasher>
+bool verifyAbsence(const typename Hasher::digest_type &rootHash, const std::string_view key,
+                   const MerkleAbsenceProof<typename Hasher::digest_type> &proof) noexcept {
+    const auto &lower = proof.lowerNeighbour;
+    const auto &upper = proof.upperNeighbour;
+
+    if (!lower && !upper) {
+        return false;
+    }
+    if (lower && !(std::string_view(lower->key) < key && verifyProof<Hasher>(rootHash, lower->proof, lower->key))) {
+        return false;
+    }
+    if (upper && !(key < std::string_view(upper->key) && verifyProof<Hasher>(rootHash, upper->proof, upper->key))) {
+        return false;
+    }
+
+    /**
+     * Both leaves being in the tree is not enough, nothing may fit between them: they have to be adjacent, or the
+     * only neighbour has to be at the very end (or the very beginning) of the tree.
+     */
+    if (lower && upper) {
+        return lower->proof.treeSize == upper->proof.treeSize
+               && upper->proof.leafNodeIndex == lower->proof.leafNodeIndex + 1;
+    }
+    if (lower) {
+        return lower->proof.leafNodeIndex == lower->proof.treeSize - 1;
+    }
+    return upper->proof.leafNodeIndex == 0;
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "catch2/catch_test_macros.hpp"
+#include "sorted_merkle_tree.hpp"
+
+
+TEST_CASE("SortedMerkleTree", "[sorted_merkle_tree]") {
+    SECTION("Generating absence proof in empty tree throws exception") {
+        const SortedMerkleTree tree;
+        REQUIRE_THROWS_AS(tree.generateAbsenceProof("key"), MerkleTreeEmptyException);
+    }
+
+    SECTION("Leaves are the hashes of the keys in sorted order") {
+        SortedMerkleTree tree;
+        REQUIRE(tree.insert("c"));
+        REQUIRE(tree.insert("a"));
+        REQUIRE(tree.insert("d"));
+        REQUIRE(tree.insert("b"));
+        REQUIRE_FALSE(tree.insert("a"));
+
+        MerkleTree reference;
+        for (const char *key: {"a", "b", "c", "d"}) {
+            reference.addHashOf(key);
+        }
+
+        REQUIRE(tree.getTreeSize() == 4);
+        REQUIRE(tree.getRootHash() == reference.getRootHash());
+        REQUIRE(tree.find("c") == 2);
+        REQUIRE_FALSE(tree.find("e").has_value());
+    }
+
+    SECTION("Batch insertion gives the same tree as inserting one key at a time") {
+        std::vector<std::string> keys;
+        for (int i = 0; i < 300; i++) {
+            keys.push_back("key " + std::to_string(i * 7919 % 300));
+        }
+
+        SortedMerkleTree<Sha256Hasher> oneByOne, inBatches;
+        for (const std::string &key: keys) {
+            oneByOne.insert(key);
+        }
+
+        REQUIRE(inBatches.insert(std::span(keys).first(100)) == 100);
+        REQUIRE(inBatches.insert(std::span(keys).first(200)) == 100);
+        REQUIRE(inBatches.insert(keys) == 100);
+
+        REQUIRE(inBatches.getTreeSize() == 300);
+        REQUIRE(inBatches.getRootHash() == oneByOne.getRootHash());
+    }
+
+    SECTION("Proofs of presence and absence") {
+        std::vector<std::string> keys;
+        for (int i = 0; i < 200; i += 2) {
+            keys.push_back(std::to_string(1000 + i));
+        }
+
+        SortedMerkleTree<Sha256Hasher> tree;
+        tree.insert(keys);
+        const Sha256Digest rootHash = tree.getRootHash();
+
+        for (int i = 0; i < 200; i++) {
+            const std::string key = std::to_string(1000 + i);
+            if (i % 2 == 0) {
+                REQUIRE(verifyProof<Sha256Hasher>(rootHash, tree.generateProof(key), key));
+                REQUIRE_THROWS_AS(tree.generateAbsenceProof(key), MerkleKeyFoundException);
+            } else {
+                REQUIRE(verifyAbsence<Sha256Hasher>(rootHash, key, tree.generateAbsenceProof(key)));
+                REQUIRE_THROWS_AS(tree.generateProof(key), MerkleKeyNotFoundException);
+            }
+        }
+
+        /**
+         * Keys before the first and after the last key only have one neighbour.
+         */
+        const auto firstProof = tree.generateAbsenceProof("0");
+        REQUIRE_FALSE(firstProof.lowerNeighbour.has_value());
+        REQUIRE(verifyAbsence<Sha256Hasher>(rootHash, "0", firstProof));
+
+        const auto lastProof = tree.generateAbsenceProof("9");
+        REQUIRE_FALSE(lastProof.upperNeighbour.has_value());
+        REQUIRE(verifyAbsence<Sha256Hasher>(rootHash, "9", lastProof));
+    }
+
+    SECTION("Absence proofs of present keys and of non-adjacent neighbours are rejected") {
+        SortedMerkleTree<Sha256Hasher> tree;
+        const std::vector<std::string> keys = {"b", "d", "f", "h", "j"};
+        tree.insert(keys);
+        const Sha256Digest rootHash = tree.getRootHash();
+
+        const auto proof = tree.generateAbsenceProof("e");
+        REQUIRE(verifyAbsence<Sha256Hasher>(rootHash, "e", proof));
+        REQUIRE_FALSE(verifyAbsence<Sha256Hasher>(rootHash, "d", proof));
+        REQUIRE_FALSE(verifyAbsence<Sha256Hasher>(rootHash, "g", proof));
+
+        /**
+         * "b" and "h" are both in the tree and bracket "f", but "d" and "f" are between them.
+         */
+        MerkleAbsenceProof<Sha256Digest> gapProof;
+        gapProof.lowerNeighbour = {"b", tree.generateProof("b")};
+        gapProof.upperNeighbour = {"h", tree.generateProof("h")};
+        REQUIRE_FALSE(verifyAbsence<Sha256Hasher>(rootHash, "f", gapProof));
+
+        /**
+         * Nor can the neighbours be left out: "h" is not the last key, "d" is not the first one.
+         */
+        MerkleAbsenceProof<Sha256Digest> lowerOnlyProof;
+        lowerOnlyProof.lowerNeighbour = {"h", tree.generateProof("h")};
+        REQUIRE_FALSE(verifyAbsence<Sha256Hasher>(rootHash, "i", lowerOnlyProof));
+
+        MerkleAbsenceProof<Sha256Digest> upperOnlyProof;
+        upperOnlyProof.upperNeighbour = {"d", tree.generateProof("d")};
+        REQUIRE_FALSE(verifyAbsence<Sha256Hasher>(rootHash, "c", upperOnlyProof));
+
+        REQUIRE_FALSE(verifyAbsence<Sha256Hasher>(rootHash, "c", MerkleAbsenceProof<Sha256Digest>{}));
+    }
+
+    SECTION("Random insertions keep the tree sorted") {
+        std::mt19937 random(11);
+        std::vector<std::string> insertedKeys;
+        SortedMerkleTree tree;
+
+        for (int i = 0; i < 200; i++) {
+            const std::string key = std::to_string(random() % 1000);
+            const bool isNewKey = std::find(insertedKeys.begin(), insertedKeys.end(), key) == insertedKeys.end();
+
+            REQUIRE(tree.insert(key) == isNewKey);
+            REQUIRE(tree.contains(key));
+            if (isNewKey) {
+                insertedKeys.push_back(key);
+            }
+        }
+
+        std::sort(insertedKeys.begin(), insertedKeys.end());
+        MerkleTree reference;
+        reference.addHashesOf(insertedKeys);
+        REQUIRE(tree.getRootHash() == reference.getRootHash());
+    }
+}
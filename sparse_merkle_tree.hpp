@@ -0,0 +1,211 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "merkle_tree_hashers.hpp"
+
+
+/**
+ * A key of a SparseMerkleTree, which is also the path from the root node to the key's leaf: bit i (counting from the
+ * most significant bit of the first byte) tells whether the path goes left (0) or right (1) on depth i.
+ */
+using SparseMerkleKey = std::array<std::uint8_t, 32>;
+
+/**
+ * A proof that a key is or is not in a SparseMerkleTree, generated by `SparseMerkleTree::generateProof` and checked
+ * with `verifySparseInclusion` or `verifySparseNonInclusion`.
+ *
+ * The path of the key ends at the topmost node that is not an inner node: either an empty subtree or a subtree with
+ * a single leaf, which is either the key itself or another key that shares the path up to that node.
+ */
+template<typename Digest>
+struct SparseMerkleProof {
+    /**
+     * Hashes of the sibling nodes on the path from the end of the path up to the root node. The number of hashes is
+     * the depth at which the path ends.
+     */
+    std::vector<Digest> siblingHashes;
+
+    /**
+     * Whether the path ends at a leaf (otherwise it ends at an empty subtree).
+     */
+    bool hasLeaf = false;
+
+    SparseMerkleKey leafKey{};
+
+    Digest leafValueHash{};
+};
+
+/**
+ * A key-value commitment: a Merkle tree of height 256 with a leaf for every possible 256-bit key, almost all of which
+ * are empty. The position of a value is given by its key (e.g. the SHA-256 hash of a name, see `keyOf`), not by the
+ * order of insertion as in MerkleTree.
+ *
+ * Two shortcuts keep the cost proportional to the number of keys rather than to the height:
+ *
+ * - empty subtrees are never stored or hashed, their hashes come from EmptySubtreeHashes,
+ * - paths are compressed: a subtree holding a single key is represented by that key's leaf node, whose hash commits to
+ *   the key as well as the value (see `hashLeafNode`), so a leaf sits just below the depth at which its key parts from
+ *   all the others. For random keys, that is about log2(n) levels deep.
+ *
+ * Only the non-empty nodes are stored, in a hash map keyed by their position, so get, put and remove take O(log n)
+ * lookups and hashes.
+ */
+template<MerkleHasher Hasher = StdHasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+struct SparseMerkleTree {
+
+public:
+
+    using hash_t = typename Hasher::digest_type;
+    using proof_t = SparseMerkleProof<hash_t>;
+
+    static constexpr std::size_t treeHeight = EmptySubtreeHashes<Hasher>::maxHeight;
+
+private:
+
+    /**
+     * Position of a node, like MerkleTree's MerkleNode: the level counted from the bottom (leaves on level 0, the root
+     * node on level treeHeight) and the index of the node on its level, stored as the key bits above the level (the
+     * path from the root node to this node) with the remaining bits set to 0.
+     */
+    struct SparseNode {
+        std::size_t level;
+
+        SparseMerkleKey prefix;
+
+        bool operator==(const SparseNode &other) const noexcept = default;
+
+        [[nodiscard]] SparseNode getParentNode() const noexcept;
+
+        [[nodiscard]] SparseNode getSiblingNode() const noexcept;
+
+        /**
+         * @return the left (isRight = false) or the right (isRight = true) child of this node.
+         */
+        [[nodiscard]] SparseNode getChild(bool isRight) const noexcept;
+    };
+
+    struct SparseNodeHash {
+        [[nodiscard]] std::size_t operator()(const SparseNode &node) const noexcept;
+    };
+
+    /**
+     * A non-empty node: an inner node (with at least two keys below it) or the leaf node of a single key.
+     */
+    struct StoredNode {
+        hash_t hash;
+
+        bool isLeaf;
+
+        SparseMerkleKey leafKey;
+
+        hash_t leafValueHash;
+    };
+
+    std::unordered_map<SparseNode, StoredNode, SparseNodeHash> nodes;
+
+    std::size_t keyCount = 0;
+
+    /**
+     * @return the topmost node on the path of the key that is not an inner node, i.e. either empty or a leaf node
+     * (of this key or of another one).
+     */
+    [[nodiscard]] SparseNode findPathEnd(const SparseMerkleKey &key) const;
+
+    /**
+     * @return the stored hash of the node, or the hash of an empty subtree if the node is not stored.
+     */
+    [[nodiscard]] hash_t getNodeHash(const SparseNode &node) const;
+
+    /**
+     * Recompute the hashes of all the ancestors of the given node, which are all inner nodes, from the bottom up.
+     */
+    void updatePathToRoot(const SparseNode &node);
+
+public:
+
+    /**
+     * @return the key for the given name, its SHA-256 hash.
+     */
+    [[nodiscard]] static SparseMerkleKey keyOf(std::string_view name) noexcept {
+        return sha256(name);
+    }
+
+    /**
+     * @return bit `depth` of the key (see SparseMerkleKey).
+     */
+    [[nodiscard]] static bool getKeyBit(const SparseMerkleKey &key, const std::size_t depth) noexcept {
+        return (key[depth / 8] >> (7 - depth % 8)) & 1;
+    }
+
+    /**
+     * @return the hash of the leaf node of the given key with a value that has the hash `valueHash`: the leaf hash of
+     * the key followed by the value hash, so that the leaf node commits to its key wherever it sits in the tree.
+     */
+    [[nodiscard]] static hash_t hashLeafNode(const SparseMerkleKey &key, const hash_t &valueHash) noexcept;
+
+    /**
+     * @return the root hash of a tree that the proof is valid for, given the key whose path the proof follows, or
+     * std::nullopt if the proof has more sibling hashes than the tree has levels.
+     */
+    [[nodiscard]] static std::optional<hash_t> computeRootHash(const SparseMerkleKey &key, const proof_t &proof) noexcept;
+
+    /**
+     * Set the value of a key, adding the key if it is not in the tree yet. Only the hash of the value is stored.
+     */
+    void put(const SparseMerkleKey &key, std::string_view value);
+
+    /**
+     * @return the hash of the value of the key (Hasher::hashLeaf of the value), or std::nullopt if the key is not in
+     * the tree.
+     */
+    [[nodiscard]] std::optional<hash_t> get(const SparseMerkleKey &key) const;
+
+    /**
+     * Remove a key from the tree, moving the leaf node of its last remaining neighbour up if it is left alone in its
+     * subtree, so that the tree looks exactly as if the key had never been added.
+     *
+     * @return true if the key was in the tree, false otherwise
+     */
+    bool remove(const SparseMerkleKey &key);
+
+    /**
+     * Get the root hash of the tree. An empty tree has the hash of an empty subtree of height treeHeight.
+     */
+    [[nodiscard]] hash_t getRootHash() const;
+
+    [[nodiscard]] std::size_t getKeyCount() const noexcept {
+        return keyCount;
+    }
+
+    /**
+     * Generate a proof for a given key, to be used in `verifySparseInclusion` if the key is in the tree and in
+     * `verifySparseNonInclusion` if it is not.
+     */
+    [[nodiscard]] proof_t generateProof(const SparseMerkleKey &key) const;
+};
+
+/**
+ * Verify whether the key had the given value in the sparse tree with the given root hash.
+ * `Hasher` has to be the same hash function policy that the tree was created with.
+ */
+template<MerkleHasher Hasher = StdHasher>
+[[nodiscard]] bool verifySparseInclusion(const typename Hasher::digest_type &rootHash, const SparseMerkleKey &key,
+                                         std::string_view value,
+                                         const SparseMerkleProof<typename Hasher::digest_type> &proof) noexcept;
+
+/**
+ * Verify whether the key was absent from the sparse tree with the given root hash, i.e. whether its path ends at an
+ * empty subtree or at the leaf node of a different key that shares the path so far.
+ * `Hasher` has to be the same hash function policy that the tree was created with.
+ */
+template<MerkleHasher Hasher = StdHasher>
+[[nodiscard]] bool verifySparseNonInclusion(const typename Hasher::digest_type &rootHash, const SparseMerkleKey &key,
+                                            const SparseMerkleProof<typename Hasher::digest_type> &proof) noexcept;
+
+
+#include "sparse_merkle_tree.tpp"
@@ -0,0 +1,235 @@
+#pragma once
+#include <cstring>
+#include <functional>
+
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+typename SparseMerkleTree<Hasher>::SparseNode SparseMerkleTree<Hasher>::SparseNode::getParentNode() const noexcept {
+    SparseNode parent = {level + 1, prefix};
+    const std::size_t depth = treeHeight - parent.level;
+    parent.prefix[depth / 8] &= static_cast<std::uint8_t>(~(0x80u >> (depth % 8)));
+    return parent;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+typename SparseMerkleTree<Hasher>::SparseNode SparseMerkleTree<Hasher>::SparseNode::getSiblingNode() const noexcept {
+    SparseNode sibling = *this;
+    const std::size_t depth = treeHeight - level - 1;
+    sibling.prefix[depth / 8] ^= static_cast<std::uint8_t>(0x80u >> (depth % 8));
+    return sibling;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+typename SparseMerkleTree<Hasher>::SparseNode SparseMerkleTree<Hasher>::SparseNode::getChild(
+        const bool isRight) const noexcept {
+    SparseNode child = {level - 1, prefix};
+    const std::size_t depth = treeHeight - level;
+    if (isRight) {
+        child.prefix[depth / 8] |= static_cast<std::uint8_t>(0x80u >> (depth % 8));
+    }
+    return child;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+std::size_t SparseMerkleTree<Hasher>::SparseNodeHash::operator()(const SparseNode &node) const noexcept {
+    const std::string_view prefixBytes(reinterpret_cast<const char *>(node.prefix.data()), node.prefix.size());
+    return std::hash<std::string_view>()(prefixBytes) * 31 + node.level;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+typename SparseMerkleTree<Hasher>::hash_t SparseMerkleTree<Hasher>::hashLeafNode(
+        const SparseMerkleKey &key, const hash_t &valueHash) noexcept {
+    std::array<char, sizeof(SparseMerkleKey) + sizeof(hash_t)> message;
+    std::memcpy(message.data(), key.data(), key.size());
+    std::memcpy(message.data() + key.size(), &valueHash, sizeof(hash_t));
+    return Hasher::hashLeaf({message.data(), message.size()});
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+std::optional<typename SparseMerkleTree<Hasher>::hash_t> SparseMerkleTree<Hasher>::computeRootHash(
+        const SparseMerkleKey &key, const proof_t &proof) noexcept {
+    const std::size_t pathEndDepth = proof.siblingHashes.size();
+    if (pathEndDepth > treeHeight) {
+        return std::nullopt;
+    }
+
+    hash_t hash = proof.hasLeaf
+                  ? hashLeafNode(proof.leafKey, proof.leafValueHash)
+                  : EmptySubtreeHashes<Hasher>::get(treeHeight - pathEndDepth);
+
+    for (std::size_t i = 0; i < pathEndDepth; i++) {
+        const hash_t &siblingHash = proof.siblingHashes[i];
+        hash = getKeyBit(key, pathEndDepth - 1 - i)
+               ? Hasher::hashNode(siblingHash, hash)
+               : Hasher::hashNode(hash, siblingHash);
+    }
+
+    return hash;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+typename SparseMerkleTree<Hasher>::SparseNode SparseMerkleTree<Hasher>::findPathEnd(const SparseMerkleKey &key) const {
+    SparseNode node = {treeHeight, {}};
+    while (true) {
+        const auto it = nodes.find(node);
+        if (it == nodes.end() || it->second.isLeaf) {
+            return node;
+        }
+
+        node = node.getChild(getKeyBit(key, treeHeight - node.level));
+    }
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+typename SparseMerkleTree<Hasher>::hash_t SparseMerkleTree<Hasher>::getNodeHash(const SparseNode &node) const {
+    const auto it = nodes.find(node);
+    return it == nodes.end() ? EmptySubtreeHashes<Hasher>::get(node.level) : it->second.hash;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+void SparseMerkleTree<Hasher>::updatePathToRoot(const SparseNode &node) {
+    SparseNode currentNode = node;
+    while (currentNode.level < treeHeight) {
+        const SparseNode parent = currentNode.getParentNode();
+        nodes[parent].hash = Hasher::hashNode(getNodeHash(parent.getChild(false)), getNodeHash(parent.getChild(true)));
+        currentNode = parent;
+    }
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+void SparseMerkleTree<Hasher>::put(const SparseMerkleKey &key, const std::string_view value) {
+    const hash_t valueHash = Hasher::hashLeaf(value);
+    SparseNode pathEnd = findPathEnd(key);
+
+    const auto it = nodes.find(pathEnd);
+    if (it == nodes.end()) {
+        keyCount++;
+    } else if (it->second.leafKey != key) {
+        /**
+         * Another key has the subtree to itself: it becomes an inner node, and both leaves move down to just below the
+         * depth at which the two keys part, with a chain of inner nodes (each with one empty child) in between.
+         */
+        const StoredNode otherLeaf = it->second;
+        it->second = StoredNode{};
+        keyCount++;
+
+        std::size_t depth = treeHeight - pathEnd.level;
+        while (getKeyBit(key, depth) == getKeyBit(otherLeaf.leafKey, depth)) {
+            pathEnd = pathEnd.getChild(getKeyBit(key, depth));
+            nodes[pathEnd] = StoredNode{};
+            depth++;
+        }
+
+        nodes[pathEnd.getChild(getKeyBit(otherLeaf.leafKey, depth))] = otherLeaf;
+        pathEnd = pathEnd.getChild(getKeyBit(key, depth));
+    }
+
+    nodes[pathEnd] = StoredNode{hashLeafNode(key, valueHash), true, key, valueHash};
+    updatePathToRoot(pathEnd);
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+std::optional<typename SparseMerkleTree<Hasher>::hash_t> SparseMerkleTree<Hasher>::get(
+        const SparseMerkleKey &key) const {
+    const auto it = nodes.find(findPathEnd(key));
+    if (it == nodes.end() || it->second.leafKey != key) {
+        return std::nullopt;
+    }
+
+    return it->second.leafValueHash;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+bool SparseMerkleTree<Hasher>::remove(const SparseMerkleKey &key) {
+    SparseNode node = findPathEnd(key);
+
+    const auto it = nodes.find(node);
+    if (it == nodes.end() || it->second.leafKey != key) {
+        return false;
+    }
+
+    nodes.erase(it);
+    keyCount--;
+
+    /**
+     * While a subtree is left with a single key, whose leaf is one child and the other child is empty, that leaf takes
+     * the place of the subtree.
+     */
+    while (node.level < treeHeight) {
+        const auto nodeIt = nodes.find(node);
+        const auto siblingIt = nodes.find(node.getSiblingNode());
+        const auto leafIt = nodeIt == nodes.end() ? siblingIt : (siblingIt == nodes.end() ? nodeIt : nodes.end());
+        if (leafIt == nodes.end() || !leafIt->second.isLeaf) {
+            break;
+        }
+
+        const StoredNode leaf = leafIt->second;
+        nodes.erase(leafIt);
+        node = node.getParentNode();
+        nodes[node] = leaf;
+    }
+
+    updatePathToRoot(node);
+    return true;
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+typename SparseMerkleTree<Hasher>::hash_t SparseMerkleTree<Hasher>::getRootHash() const {
+    return getNodeHash({treeHeight, {}});
+}
+
+template<MerkleHasher Hasher> requires std::is_trivially_copyable_v<typename Hasher::digest_type>
+typename SparseMerkleTree<Hasher>::proof_t SparseMerkleTree<Hasher>::generateProof(const SparseMerkleKey &key) const {
+    const SparseNode pathEnd = findPathEnd(key);
+
+    proof_t proof;
+    proof.siblingHashes.reserve(treeHeight - pathEnd.level);
+    for (SparseNode node = pathEnd; node.level < treeHeight; node = node.getParentNode()) {
+        proof.siblingHashes.push_back(getNodeHash(node.getSiblingNode()));
+    }
+
+    const auto it = nodes.find(pathEnd);
+    if (it != nodes.end()) {
+        proof.hasLeaf = true;
+        proof.leafKey = it->second.leafKey;
+        proof.leafValueHash = it->second.leafValueHash;
+    }
+
+    return proof;
+}
+
+template<MerkleHasher Hasher>
+bool verifySparseInclusion(const typename Hasher::digest_type &rootHash, const SparseMerkleKey &key,
+                           const std::string_view value,
+                           const SparseMerkleProof<typename Hasher::digest_type> &proof) noexcept {
+    if (!proof.hasLeaf || proof.leafKey != key || proof.leafValueHash != Hasher::hashLeaf(value)) {
+        return false;
+    }
+
+    const auto computedRootHash = SparseMerkleTree<Hasher>::computeRootHash(key, proof);
+    return computedRootHash && *computedRootHash == rootHash;
+}
+
+template<MerkleHasher Hasher>
+bool verifySparseNonInclusion(const typename Hasher::digest_type &rootHash, const SparseMerkleKey &key,
+                              const SparseMerkleProof<typename Hasher::digest_type> &proof) noexcept {
+    if (proof.hasLeaf) {
+        if (proof.leafKey == key) {
+            return false;
+        }
+
+        /**
+         * The other key's leaf has to be on the path of this key, otherwise it is not where this key would be.
+         */
+        for (std::size_t depth = 0; depth < proof.siblingHashes.size() && depth < SparseMerkleTree<Hasher>::treeHeight;
+             depth++) {
+            if (SparseMerkleTree<Hasher>::getKeyBit(key, depth)
+                != SparseMerkleTree<Hasher>::getKeyBit(proof.leafKey, depth)) {
+                return false;
+            }
+        }
+    }
+
+    const auto computedRootHash = SparseMerkleTree<Hasher>::computeRootHash(key, proof);
+    return computedRootHash && *computedRootHash == rootHash;
+}
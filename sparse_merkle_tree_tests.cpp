@@ -0,0 +1,192 @@
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "catch2/catch_test_macros.hpp"
+#include "sparse_merkle_tree.hpp"
+
+
+/**
+ * Root hash of the subtree at the given depth holding the given keys, computed from scratch by splitting the keys on
+ * every level, as a reference for the incrementally updated root hash.
+ */
+template<MerkleHasher Hasher>
+typename Hasher::digest_type computeSparseRootHash(
+        const std::vector<std::pair<SparseMerkleKey, typename Hasher::digest_type>> &leaves, const std::size_t depth) {
+    using Tree = SparseMerkleTree<Hasher>;
+
+    if (leaves.empty()) {
+        return EmptySubtreeHashes<Hasher>::get(Tree::treeHeight - depth);
+    }
+    if (leaves.size() == 1) {
+        return Tree::hashLeafNode(leaves[0].first, leaves[0].second);
+    }
+
+    std::vector<std::pair<SparseMerkleKey, typename Hasher::digest_type>> left, right;
+    for (const auto &leaf: leaves) {
+        (Tree::getKeyBit(leaf.first, depth) ? right : left).push_back(leaf);
+    }
+
+    return Hasher::hashNode(computeSparseRootHash<Hasher>(left, depth + 1),
+                            computeSparseRootHash<Hasher>(right, depth + 1));
+}
+
+TEST_CASE("SparseMerkleTree", "[sparse_merkle_tree]") {
+    using Tree = SparseMerkleTree<Sha256Hasher>;
+
+    SECTION("Empty tree has the hash of an empty subtree of height 256") {
+        const Tree tree;
+        REQUIRE(tree.getRootHash() == EmptySubtreeHashes<Sha256Hasher>::get(256));
+        REQUIRE(tree.getKeyCount() == 0);
+        REQUIRE_FALSE(tree.get(Tree::keyOf("missing")).has_value());
+    }
+
+    SECTION("Tree with a single key has the hash of its leaf node") {
+        Tree tree;
+        tree.put(Tree::keyOf("key"), "value");
+
+        REQUIRE(tree.getRootHash() == Tree::hashLeafNode(Tree::keyOf("key"), Sha256Hasher::hashLeaf("value")));
+    }
+
+    SECTION("Putting, getting and removing keys") {
+        Tree tree;
+        tree.put(Tree::keyOf("a"), "1");
+        tree.put(Tree::keyOf("b"), "2");
+
+        REQUIRE(tree.get(Tree::keyOf("a")) == Sha256Hasher::hashLeaf("1"));
+        REQUIRE(tree.get(Tree::keyOf("b")) == Sha256Hasher::hashLeaf("2"));
+        REQUIRE(tree.getKeyCount() == 2);
+
+        tree.put(Tree::keyOf("a"), "3");
+        REQUIRE(tree.get(Tree::keyOf("a")) == Sha256Hasher::hashLeaf("3"));
+        REQUIRE(tree.getKeyCount() == 2);
+
+        REQUIRE(tree.remove(Tree::keyOf("a")));
+        REQUIRE_FALSE(tree.remove(Tree::keyOf("a")));
+        REQUIRE_FALSE(tree.get(Tree::keyOf("a")).has_value());
+        REQUIRE(tree.getKeyCount() == 1);
+        REQUIRE(tree.getRootHash() == Tree::hashLeafNode(Tree::keyOf("b"), Sha256Hasher::hashLeaf("2")));
+
+        REQUIRE(tree.remove(Tree::keyOf("b")));
+        REQUIRE(tree.getRootHash() == EmptySubtreeHashes<Sha256Hasher>::get(256));
+    }
+
+    SECTION("Root hash matches a root hash computed from scratch after random puts and removes") {
+        Tree tree;
+        std::map<SparseMerkleKey, Sha256Digest> reference;
+        std::mt19937 random(7);
+
+        for (int i = 0; i < 500; i++) {
+            const SparseMerkleKey key = Tree::keyOf("key " + std::to_string(random() % 200));
+            if (random() % 3 == 0) {
+                REQUIRE(tree.remove(key) == (reference.erase(key) == 1));
+            } else {
+                const std::string value = "value " + std::to_string(i);
+                tree.put(key, value);
+                reference[key] = Sha256Hasher::hashLeaf(value);
+            }
+
+            REQUIRE(tree.getKeyCount() == reference.size());
+            REQUIRE(tree.getRootHash() == computeSparseRootHash<Sha256Hasher>({reference.begin(), reference.end()}, 0));
+        }
+    }
+
+    SECTION("Root hash does not depend on the order of insertion") {
+        Tree forwards, backwards;
+        for (int i = 0; i < 100; i++) {
+            forwards.put(Tree::keyOf(std::to_string(i)), std::to_string(i));
+            backwards.put(Tree::keyOf(std::to_string(99 - i)), std::to_string(99 - i));
+        }
+
+        REQUIRE(forwards.getRootHash() == backwards.getRootHash());
+    }
+
+    SECTION("Keys that differ only in the last bit are split at the bottom level") {
+        SparseMerkleKey first{}, second{};
+        second[31] = 1;
+
+        Tree tree;
+        tree.put(first, "first");
+        tree.put(second, "second");
+
+        const auto proof = tree.generateProof(second);
+        REQUIRE(proof.siblingHashes.size() == 256);
+        REQUIRE(verifySparseInclusion<Sha256Hasher>(tree.getRootHash(), second, "second", proof));
+        REQUIRE(tree.getRootHash() == computeSparseRootHash<Sha256Hasher>(
+                {{first, Sha256Hasher::hashLeaf("first")}, {second, Sha256Hasher::hashLeaf("second")}}, 0));
+
+        REQUIRE(tree.remove(first));
+        REQUIRE(tree.getRootHash() == Tree::hashLeafNode(second, Sha256Hasher::hashLeaf("second")));
+    }
+
+    SECTION("Proofs of inclusion and non-inclusion") {
+        Tree tree;
+        for (int i = 0; i < 1000; i++) {
+            tree.put(Tree::keyOf("key " + std::to_string(i)), "value " + std::to_string(i));
+        }
+        const Sha256Digest rootHash = tree.getRootHash();
+
+        for (int i = 0; i < 1000; i++) {
+            const SparseMerkleKey key = Tree::keyOf("key " + std::to_string(i));
+            const auto proof = tree.generateProof(key);
+
+            REQUIRE(proof.siblingHashes.size() < 40);
+            REQUIRE(verifySparseInclusion<Sha256Hasher>(rootHash, key, "value " + std::to_string(i), proof));
+            REQUIRE_FALSE(verifySparseInclusion<Sha256Hasher>(rootHash, key, "other value", proof));
+            REQUIRE_FALSE(verifySparseNonInclusion<Sha256Hasher>(rootHash, key, proof));
+        }
+
+        bool endedAtLeaf = false, endedAtEmptySubtree = false;
+        for (int i = 1000; i < 2000; i++) {
+            const SparseMerkleKey key = Tree::keyOf("key " + std::to_string(i));
+            const auto proof = tree.generateProof(key);
+            (proof.hasLeaf ? endedAtLeaf : endedAtEmptySubtree) = true;
+
+            REQUIRE(verifySparseNonInclusion<Sha256Hasher>(rootHash, key, proof));
+            REQUIRE_FALSE(verifySparseInclusion<Sha256Hasher>(rootHash, key, "value " + std::to_string(i), proof));
+        }
+        REQUIRE(endedAtLeaf);
+        REQUIRE(endedAtEmptySubtree);
+    }
+
+    SECTION("Tampered proofs are rejected") {
+        Tree tree;
+        for (int i = 0; i < 100; i++) {
+            tree.put(Tree::keyOf(std::to_string(i)), std::to_string(i));
+        }
+        const Sha256Digest rootHash = tree.getRootHash();
+        const SparseMerkleKey key = Tree::keyOf("42");
+
+        auto proof = tree.generateProof(key);
+        proof.siblingHashes[0][0] ^= 1;
+        REQUIRE_FALSE(verifySparseInclusion<Sha256Hasher>(rootHash, key, "42", proof));
+
+        proof = tree.generateProof(key);
+        proof.siblingHashes.pop_back();
+        REQUIRE_FALSE(verifySparseInclusion<Sha256Hasher>(rootHash, key, "42", proof));
+
+        /**
+         * A proof of a present key cannot be turned into a proof of its absence by dropping the leaf.
+         */
+        proof = tree.generateProof(key);
+        proof.hasLeaf = false;
+        REQUIRE_FALSE(verifySparseNonInclusion<Sha256Hasher>(rootHash, key, proof));
+
+        /**
+         * Nor by presenting the proof of another key whose path does not lead to this one.
+         */
+        const SparseMerkleKey otherKey = Tree::keyOf("43");
+        REQUIRE_FALSE(verifySparseNonInclusion<Sha256Hasher>(rootHash, key, tree.generateProof(otherKey)));
+    }
+
+    SECTION("Works with the default hasher") {
+        SparseMerkleTree tree;
+        tree.put(SparseMerkleTree<>::keyOf("a"), "1");
+        tree.put(SparseMerkleTree<>::keyOf("b"), "2");
+
+        const auto proof = tree.generateProof(SparseMerkleTree<>::keyOf("a"));
+        REQUIRE(verifySparseInclusion(tree.getRootHash(), SparseMerkleTree<>::keyOf("a"), "1", proof));
+        REQUIRE(verifySparseNonInclusion(tree.getRootHash(), SparseMerkleTree<>::keyOf("c"),
+                                         tree.generateProof(SparseMerkleTree<>::keyOf("c"))));
+    }
+}